@@ -1,95 +1,215 @@
 #include "input/BaseGestureRecognizer.h"
+#include "input/GestureStates.h"
+#include "input/GesturePolicy.h"
+#include "input/PointCloudRecognizer.h"
+#include "input/GestureFixedPoint.h"
+#include "input/GestureMemory.h"
 
-static unsigned int _MAX_INTERVAL_OF_DOUBLE_CLICK_      = 300;
-static unsigned int _MIN_STEADY_TIME_FOR_DRAG           = 200;
-static unsigned int _MIN_TIME_FOR_LONG_TAP              = 500;
-static unsigned int _MAX_TIME_FOR_SWIPE                 = 700;
-static float _MIN_X_RATIO_FOR_ARC                       = 0.5f;
-static float _MIN_Y_CHANGE_PERSENT_FOR_ARC              = 0.25f;
-static float _MAX_DISTANCE_RATIO_FOR_STEADY             = 0.005f;
-static float _MAX_ANGLE_COS_VALUE_FOR_ROTATE            = 0.98f;
-static float _MAX_SWIPE_DURATION_FOR_WHOLE_SCREEN       = 0.5f;
-
-enum TouchQueueChangingMode
-{
-    TQC_NONE        = 0,
-    TQC_PRESS       = 1,
-    TQC_MOVE        = 2,
-    TQC_RELEASE     = 3,
-};
+static unsigned int _GESTURE_EVENT_QUEUE_CAPACITY_      = 64;
+static unsigned int _MIN_TOUCH_QUEUE_INFOMATION_SLOTS_  = 16;
+#define _MAX_RECOGNIZER_FACTORIES_                      16
 
 //--------------------------------------------- BaseGestureRecognizer ---------------------------------------------
-BaseGestureRecognizer::BaseGestureRecognizer() : mId("BaseGestureRecognizer")
+BaseGestureRecognizer::BaseGestureRecognizer() : mId("BaseGestureRecognizer"), mGestureEvents(_GESTURE_EVENT_QUEUE_CAPACITY_),
+        mTraceSink(0), mTraceId(0), mPredictionHorizon(DefaultGesturePolicy::PREDICTION_HORIZON),
+        mInMultiTouchMove(false), mLastMultiTouchMoveX(0), mLastMultiTouchMoveY(0), mTouchQueueInfomations(0), mTouchQueueInfomationCapacity(0),
+        mFirstChanged(NO_CHANGED_SLOT), mLastChanged(NO_CHANGED_SLOT), mChangedCount(0), mFixedTouchQueueInfomations(false)
 {
-    mCurrentGestureEvent = new BaseGestureEvent();
-    InitializeDefaultParameters();
+    BaseGestureRecognizer::Initialize();
 }
 
 BaseGestureRecognizer::~BaseGestureRecognizer()
 {
-    SAFE_DELETE(mCurrentGestureEvent);
+    if (!mFixedTouchQueueInfomations)
+        FreeTouchQueueInfomations();
+}
+
+static BaseGestureRecognizer *_CreateBaseGestureRecognizer()
+{
+    return new BaseGestureRecognizer();
+}
+
+static BaseGestureRecognizer *_CreatePointCloudRecognizer()
+{
+    return new PointCloudRecognizer();
+}
+
+struct RecognizerFactory
+{
+    const char *id;
+    BaseGestureRecognizer::Factory factory;
+};
+
+static RecognizerFactory _recognizer_factories[_MAX_RECOGNIZER_FACTORIES_] =
+{
+    {"BaseGestureRecognizer", _CreateBaseGestureRecognizer},
+    {"PointCloudRecognizer", _CreatePointCloudRecognizer},
+};
+static unsigned int _recognizer_factory_count = 2;
+
+bool BaseGestureRecognizer::RegisterFactory(const char *id, Factory factory)
+{
+    for (unsigned int i=0; i<_recognizer_factory_count; i++)
+    {
+        if (strcmp(_recognizer_factories[i].id, id) == 0)
+            return false;
+    }
+    if (_recognizer_factory_count == _MAX_RECOGNIZER_FACTORIES_)
+        return false;
+    _recognizer_factories[_recognizer_factory_count].id = id;
+    _recognizer_factories[_recognizer_factory_count].factory = factory;
+    _recognizer_factory_count ++;
+    return true;
 }
 
 BaseGestureRecognizer *BaseGestureRecognizer::Create(const char *id)
 {
-    if (strcmp("BaseGestureRecognizer", id) == 0)
-        return new BaseGestureRecognizer();
+    for (unsigned int i=0; i<_recognizer_factory_count; i++)
+    {
+        if (strcmp(_recognizer_factories[i].id, id) == 0)
+            return _recognizer_factories[i].factory();
+    }
     return 0;
 }
 
 void BaseGestureRecognizer::Initialize()
 {
-    InitializeDefaultParameters();
+    unsigned int width, height;
+    GestureViewport::GetSize(width, height);
+    InitializeDefaultParameters(width, height);
 }
 
-void BaseGestureRecognizer::InitializeDefaultParameters()
+void BaseGestureRecognizer::Initialize(unsigned int viewportWidth, unsigned int viewportHeight)
 {
-    mMaxIntervalOfDoubleClick = _MAX_INTERVAL_OF_DOUBLE_CLICK_;
-    mMinSteadyTimeForDrag = _MIN_STEADY_TIME_FOR_DRAG;
-    mMinTimeForLongTap = _MIN_TIME_FOR_LONG_TAP;
-    mMinYChangePersentForArc = _MIN_Y_CHANGE_PERSENT_FOR_ARC;
-    mMaxSwipeDuration = _MAX_TIME_FOR_SWIPE;
+    InitializeDefaultParameters(viewportWidth, viewportHeight);
+}
 
-    mMaxAngleCosValForRotate = _MAX_ANGLE_COS_VALUE_FOR_ROTATE;
+void BaseGestureRecognizer::InitializeDefaultParameters(unsigned int width, unsigned int height)
+{
+    typedef DefaultGesturePolicy P;
+    mMaxIntervalOfDoubleClick = P::MAX_INTERVAL_OF_DOUBLE_CLICK;
+    mMinSteadyTimeForDrag = P::MIN_STEADY_TIME_FOR_DRAG;
+    mMinTimeForLongTap = P::MIN_TIME_FOR_LONG_TAP;
+    mMinYChangePersentForArc = P::MIN_Y_CHANGE_PERSENT_FOR_ARC;
+    mMaxSwipeDuration = P::MAX_TIME_FOR_SWIPE;
+
+    mMaxAngleCosValForRotate = P::MAX_ANGLE_COS_VALUE_FOR_ROTATE;
+    mMaxDistanceRatioForSteady = P::MAX_DISTANCE_RATIO_FOR_STEADY;
     
-    unsigned int width = Game::GetInstance()->GetViewport().width;
-    mMinXDistanceForArc = (int)(_MIN_X_RATIO_FOR_ARC * width + 0.5f);
+    mMinXDistanceForArc = (int)(P::MIN_X_RATIO_FOR_ARC * width + 0.5f);
     
-    mMaxSteadyMoveDistanceX = (int)(_MAX_DISTANCE_RATIO_FOR_STEADY * width + 0.5f);
-    unsigned int height = Game::GetInstance()->GetViewport().height;
-    mMaxSteadyMoveDistanceY = (int)(_MAX_DISTANCE_RATIO_FOR_STEADY * height + 0.5f);
+    mMaxSteadyMoveDistanceX = (int)(P::MAX_DISTANCE_RATIO_FOR_STEADY * width + 0.5f);
+    mMaxSteadyMoveDistanceY = (int)(P::MAX_DISTANCE_RATIO_FOR_STEADY * height + 0.5f);
     
-    mMinSpeedForSwipe = sqrtf((float)((width * width) + (height * height))) / _MAX_SWIPE_DURATION_FOR_WHOLE_SCREEN;
+    mMinSpeedForSwipe = sqrtf((float)((width * width) + (height * height))) / P::MAX_SWIPE_DURATION_FOR_WHOLE_SCREEN;
+#ifdef GESTURE_FIXED_POINT
+    //the pixel thresholds from the ratios in millionths, no float rounding of the viewport products
+    mMinXDistanceForArc = (int)FixedPoint::ScaleMillionths(width, FixedPoint::ToMillionths(P::MIN_X_RATIO_FOR_ARC));
+    mMaxSteadyMoveDistanceX = (int)FixedPoint::ScaleMillionths(width, FixedPoint::ToMillionths(P::MAX_DISTANCE_RATIO_FOR_STEADY));
+    mMaxSteadyMoveDistanceY = (int)FixedPoint::ScaleMillionths(height, FixedPoint::ToMillionths(P::MAX_DISTANCE_RATIO_FOR_STEADY));
+    mMinSpeedSquaredForSwipe = FixedPoint::SwipeSpeedSquared(width, height, FixedPoint::ToMillionths(P::MAX_SWIPE_DURATION_FOR_WHOLE_SCREEN));
+    mMaxDistanceSquaredForSteady = FixedPoint::SquaredLengthThreshold(FixedPoint::ToMillionths(P::MAX_DISTANCE_RATIO_FOR_STEADY));
+#endif
 }
 
-void BaseGestureRecognizer::ResetCurrentGesture()
+void BaseGestureRecognizer::ClearGestureEvents()
 {
-    mCurrentGestureEvent->~BaseGestureEvent();
-    new (mCurrentGestureEvent) BaseGestureEvent();
+    mGestureEvents.Clear();
+}
+
+void BaseGestureRecognizer::Reset()
+{
+    for (unsigned int i=0; i<mTouchQueueInfomationCapacity; i++)
+        mTouchQueueInfomations[i] = TouchQueueInfomation();
+    mFirstChanged = mLastChanged = NO_CHANGED_SLOT;
+    mChangedCount = 0;
+    mInMultiTouchMove = false;
+    mLastMultiTouchMoveX = mLastMultiTouchMoveY = 0;
+    ClearGestureEvents();
+}
+
+void BaseGestureRecognizer::ReserveTouchQueueInfomations(unsigned int slotCount)
+{
+    if (slotCount <= mTouchQueueInfomationCapacity)
+        return;
+    //a fixed table is sized for every slot of its manager
+    assert(!mFixedTouchQueueInfomations);
+    unsigned int capacity = mTouchQueueInfomationCapacity ? mTouchQueueInfomationCapacity : _MIN_TOUCH_QUEUE_INFOMATION_SLOTS_;
+    while (capacity < slotCount)
+        capacity *= 2;
+    TouchQueueInfomation *infomations = (TouchQueueInfomation *)GestureMemory::Allocate(sizeof(TouchQueueInfomation) * capacity);
+    for (unsigned int i=0; i<capacity; i++)
+        new (infomations + i) TouchQueueInfomation();
+    for (unsigned int i=0; i<mTouchQueueInfomationCapacity; i++)
+        infomations[i] = mTouchQueueInfomations[i];
+    FreeTouchQueueInfomations();
+    mTouchQueueInfomations = infomations;
+    mTouchQueueInfomationCapacity = capacity;
+}
+
+void BaseGestureRecognizer::FreeTouchQueueInfomations()
+{
+    for (unsigned int i=0; i<mTouchQueueInfomationCapacity; i++)
+        mTouchQueueInfomations[i].~TouchQueueInfomation();
+    GestureMemory::Free(mTouchQueueInfomations);
+    mTouchQueueInfomations = 0;
+    mTouchQueueInfomationCapacity = 0;
+}
+
+void BaseGestureRecognizer::UseTouchQueueInfomations(TouchQueueInfomation *infomations, unsigned int capacity)
+{
+    assert(!mChangedCount);
+    if (!mFixedTouchQueueInfomations)
+        FreeTouchQueueInfomations();
+    mTouchQueueInfomations = infomations;
+    mTouchQueueInfomationCapacity = capacity;
+    mFixedTouchQueueInfomations = true;
+}
+
+void BaseGestureRecognizer::LinkChanged(unsigned int slot)
+{
+    TouchQueueInfomation &info = mTouchQueueInfomations[slot];
+    info.prevChanged = mLastChanged;
+    info.nextChanged = NO_CHANGED_SLOT;
+    if (mLastChanged != NO_CHANGED_SLOT)
+        mTouchQueueInfomations[mLastChanged].nextChanged = slot;
+    else
+        mFirstChanged = slot;
+    mLastChanged = slot;
+    mChangedCount ++;
+}
+
+void BaseGestureRecognizer::UnlinkChanged(unsigned int slot)
+{
+    TouchQueueInfomation &info = mTouchQueueInfomations[slot];
+    if (info.prevChanged != NO_CHANGED_SLOT)
+        mTouchQueueInfomations[info.prevChanged].nextChanged = info.nextChanged;
+    else
+        mFirstChanged = info.nextChanged;
+    if (info.nextChanged != NO_CHANGED_SLOT)
+        mTouchQueueInfomations[info.nextChanged].prevChanged = info.prevChanged;
+    else
+        mLastChanged = info.prevChanged;
+    mChangedCount --;
+    info = TouchQueueInfomation();
 }
 
 BaseGestureRecognizer::TouchQueueInfomation &BaseGestureRecognizer::FindQueueInfomation(TouchQueue *queue)
 {
     static BaseGestureRecognizer::TouchQueueInfomation _empty_infomation;
-    for (unsigned int i=0; i<mChangedTouchQueues.Size(); i++)
-    {
-        if (mChangedTouchQueues[i].touchQueue == queue)
-            return mChangedTouchQueues[i];
-    }
+    unsigned int slot = queue->GetTouchIndex();
+    if ((slot < mTouchQueueInfomationCapacity) && (mTouchQueueInfomations[slot].touchQueue == queue))
+        return mTouchQueueInfomations[slot];
     return _empty_infomation;
 }
 
 void BaseGestureRecognizer::TryRemoveTouchQueueInfomation(TouchQueue *queue)
 {
-    for (unsigned int i=0; i<mChangedTouchQueues.Size(); i++)
-    {
-        if (mChangedTouchQueues[i].touchQueue == queue)
-        {
-            mChangedTouchQueues.RemoveAtIndex(i);
-            queue->Clear();
-            break;
-        }
-    }
+    //the queue itself is shared with the other recognizers, only the state is dropped
+    BaseGestureRecognizer::TouchQueueInfomation &info = FindQueueInfomation(queue);
+    if (info.IsEmpty())
+        return;
+    UnlinkChanged(queue->GetTouchIndex());
 }
 
 bool BaseGestureRecognizer::TryAddTouchQueueChanging(TouchQueue *queue, int changingMode, HexTime time)
@@ -99,8 +219,13 @@ bool BaseGestureRecognizer::TryAddTouchQueueChanging(TouchQueue *queue, int chan
     {
         if (changingMode == TQC_PRESS)
         {
-            BaseGestureRecognizer::TouchQueueInfomation tqcInfo(queue, changingMode, time);
-            mChangedTouchQueues.Push(tqcInfo);
+            unsigned int slot = queue->GetTouchIndex();
+            ReserveTouchQueueInfomations(slot + 1);
+            //one queue per slot
+            assert(mTouchQueueInfomations[slot].IsEmpty());
+            mTouchQueueInfomations[slot] = BaseGestureRecognizer::TouchQueueInfomation(queue, changingMode, time);
+            LinkChanged(slot);
+            TraceTransition(slot, STATE_NONE, mTouchQueueInfomations[slot].curState, time);
             return true;
         }
         return false;
@@ -123,375 +248,50 @@ bool BaseGestureRecognizer::TryAddTouchQueueChanging(TouchQueue *queue, int chan
 
 void BaseGestureRecognizer::OnTapState(TouchQueueInfomation &info, HexTime time)
 {
-    int x, y;
-    if (!info.touchQueue->IsActived())
-    {
-        // touch release
-        if (info.repeatTimes <= 1)
-        {
-            info.touchQueue->GetTrackStartingPosition(x, y);
-            if (info.releaseTime + mMaxIntervalOfDoubleClick < time)
-            {
-                // tap event
-                ResetCurrentGesture();
-                new (mCurrentGestureEvent) GestureTapEvent(x, y, time, 1);
-            }
-            else
-            {
-                mChangedTouchQueues.Push(info);
-            }
-            return;
-        }
-        else
-        {
-            // double click
-            info.curState = STATE_DOUBLE_TAP;
-            mChangedTouchQueues.Push(info);
-            return;
-        }
-    }
-    else
-    {
-        info.touchQueue->GetAbsMaxMovingDistance(x, y);
-        if ((x > mMaxSteadyMoveDistanceX) || (y > mMaxSteadyMoveDistanceY))
-        {
-            // point moved, change to swipe or move state
-            float maxSpeed;
-            float avgSpeed;
-            bool gotSpeed = info.touchQueue->GetMovingSpeeds(maxSpeed, avgSpeed);
-            if (gotSpeed && (maxSpeed < mMinSpeedForSwipe))
-            {
-                info.curState = STATE_MOVE;
-            }
-            else
-            {
-                info.curState = STATE_SWIPE;
-            }
-            mChangedTouchQueues.Push(info);
-            return;
-        }
-        //printf("OnTapState %u\n", info.touchQueue->GetCurrentDuration(time));
-        info.touchQueue->GetTrackStartingPosition(x, y);
-        if (info.touchQueue->GetCurrentDuration(time) > mMinSteadyTimeForDrag)
-        {
-            info.curState = STATE_DRAG;
-            /*
-            ResetCurrentGesture();
-            new (mCurrentGestureEvent) GestureDragEvent(x, y, time, 1);
-            */
-            mChangedTouchQueues.Push(info);
-            return;
-        }
-        mChangedTouchQueues.Push(info);
-    }
+    GestureStates<BaseGestureRecognizer>::OnTapState(*this, info, time);
 }
 
 void BaseGestureRecognizer::OnSwipeState(TouchQueueInfomation &info, HexTime time)
 {
-    int x, y;
-    info.touchQueue->GetTrackStartingPosition(x, y);
-    if (!info.touchQueue->IsActived() || (info.touchQueue->GetCurrentDuration(time) >= mMaxSwipeDuration))
-    {
-        ResetCurrentGesture();
-
-        TouchQueue::ArcShape arcType;
-        TouchQueue::Direction direction;
-        bool isArc = info.touchQueue->IsArcTrack(mMinXDistanceForArc, mMinYChangePersentForArc, arcType, direction);
-        if (isArc)
-            new (mCurrentGestureEvent) GestureArcEvent(x, y, time, 1, arcType, direction);
-        else
-            new (mCurrentGestureEvent) GestureSwipeEvent(x, y, time, 1, direction);
-        
-        //force deactive the touch queue when it expired
-        if (info.touchQueue->IsActived())
-            info.touchQueue->ForceReleaseTouch();
-    }
-    else
-    {
-        mChangedTouchQueues.Push(info);
-    }
+    GestureStates<BaseGestureRecognizer>::OnSwipeState(*this, info, time);
 }
 
 void BaseGestureRecognizer::OnLongTapState(TouchQueueInfomation &info, HexTime time)
 {
-    int x, y;
-    info.touchQueue->GetTrackStartingPosition(x, y);
-    if (!info.touchQueue->IsActived())
-    {
-        ResetCurrentGesture();
-        new (mCurrentGestureEvent) GestureLongTapEvent(x, y, time, 1, info.touchQueue->GetDuration());
-    }
-    else
-    {
-        mChangedTouchQueues.Push(info);
-    }
+    GestureStates<BaseGestureRecognizer>::OnLongTapState(*this, info, time);
 }
 
 void BaseGestureRecognizer::OnDoubleTapState(TouchQueueInfomation &info, HexTime time)
 {
-    int x, y;
-    if (!info.touchQueue->IsActived())
-    {
-        ResetCurrentGesture();
-        info.touchQueue->GetTrackStartingPosition(x, y);
-        new (mCurrentGestureEvent) GestureDoubleClickEvent(x, y, time, 1);
-    }
-    else
-    {
-        info.touchQueue->GetAbsMaxMovingDistance(x, y);
-        if ((x > mMaxSteadyMoveDistanceX) || (y > mMaxSteadyMoveDistanceY))
-        {
-            // point moved, change to swipe state
-            info.curState = STATE_SWIPE;
-            mChangedTouchQueues.Push(info);
-            return;
-        }
-        if (info.touchQueue->GetCurrentDuration(time) > mMinSteadyTimeForDrag)
-        {
-            info.curState = STATE_DRAG;
-            mChangedTouchQueues.Push(info);
-            return;
-        }
-        mChangedTouchQueues.Push(info);
-    }
+    GestureStates<BaseGestureRecognizer>::OnDoubleTapState(*this, info, time);
 }
 
 void BaseGestureRecognizer::OnMoveState(TouchQueueInfomation &info, HexTime time)
 {
-    int x, y;
-    info.touchQueue->GetTrackEndingPosition(x, y);
-    if (!info.touchQueue->IsActived())
-    {
-        ResetCurrentGesture();
-        new (mCurrentGestureEvent) GestureEndMoveEvent(x, y, time, 1);
-    }
-    else
-    {
-        ResetCurrentGesture();
-        new (mCurrentGestureEvent) GestureMoveEvent(x, y, time, 1);
-        mChangedTouchQueues.Push(info);
-    }
+    GestureStates<BaseGestureRecognizer>::OnMoveState(*this, info, time);
 }
 
 void BaseGestureRecognizer::OnDragState(TouchQueueInfomation &info, HexTime time)
 {
-    int x, y;
-    if (!info.touchQueue->IsActived())
-    {
-        //release touch in drag state, triggered tap or long-tap event
-        ResetCurrentGesture();
-        info.touchQueue->GetTrackStartingPosition(x, y);
-        if (info.touchQueue->GetCurrentDuration(time) >= mMinTimeForLongTap)
-            new (mCurrentGestureEvent) GestureLongTapEvent(x, y, time, 1, info.touchQueue->GetDuration());
-        else
-            new (mCurrentGestureEvent) GestureTapEvent(x, y, time, 1);
-    }
-    else
-    {
-        info.touchQueue->GetAbsMaxMovingDistance(x, y);
-        if ((x > mMaxSteadyMoveDistanceX) || (y > mMaxSteadyMoveDistanceY))
-        {
-            // point moved, trigger drag event and change to drag-move state
-            info.touchQueue->GetTrackStartingPosition(x, y);
-            ResetCurrentGesture();
-            new (mCurrentGestureEvent) GestureDragEvent(x, y, time, 1);
-            info.curState = STATE_DRAG_MOVE;
-            mChangedTouchQueues.Push(info);
-            return;
-        }
-        mChangedTouchQueues.Push(info);
-    }
+    GestureStates<BaseGestureRecognizer>::OnDragState(*this, info, time);
 }
 
 void BaseGestureRecognizer::OnDragMoveState(TouchQueueInfomation &info, HexTime time)
 {
-    int x, y;
-    info.touchQueue->GetTrackEndingPosition(x, y);
-    if (!info.touchQueue->IsActived())
-    {
-        ResetCurrentGesture();
-        new (mCurrentGestureEvent) GestureDropEvent(x, y, time, 1);
-    }
-    else
-    {
-        ResetCurrentGesture();
-        new (mCurrentGestureEvent) GestureDragMoveEvent(x, y, time, 1);
-        mChangedTouchQueues.Push(info);
-    }
+    GestureStates<BaseGestureRecognizer>::OnDragMoveState(*this, info, time);
 }
 
-static bool _inMultiTouchMove = false;
-static int _lastMultiTouchMoveX = 0;
-static int _lastMultiTouchMoveY = 0;
-
 void BaseGestureRecognizer::OnMultiTouch(HexTime time)
 {
-    DataStructures::Queue<TouchQueue *> temp;
-    int count = mChangedTouchQueues.Size();
-    for (int i = 0; i < count; ++i)
-    {
-        if (mChangedTouchQueues[i].touchQueue->IsActived())
-        {
-            temp.Push(mChangedTouchQueues[i].touchQueue);
-            mChangedTouchQueues[i].curState = STATE_MULTI;
-        }
-    }
-    count = temp.Size();
-    if (count == 2) // rotate pinch
-    {
-        int x0, y0, x1, y1;
-        temp[0]->GetTrackStartingPosition(x0, y0);
-        FastMath::Vector3 p0 = FastMath::Vector3(x0, y0, 0.0f);
-        temp[0]->GetTrackEndingPosition(x1, y1);
-        FastMath::Vector3 p1 = FastMath::Vector3(x1, y1, 0.0f);
-        FastMath::Vector3 v0 = FastMath::Vector3(x1 - x0, y1 - y0, 0.0f);
-        temp[1]->GetTrackStartingPosition(x0, y0);
-        FastMath::Vector3 p2 = FastMath::Vector3(x0, y0, 0.0f);
-        temp[1]->GetTrackEndingPosition(x1, y1);
-        FastMath::Vector3 p3 = FastMath::Vector3(x1, y1, 0.0f);
-        FastMath::Vector3 v1 = FastMath::Vector3(x1 - x0, y1 - y0, 0.0f);
-        float len1 = v0.Length();
-        float len2 = v1.Length();
-        if ((len1 < _MAX_DISTANCE_RATIO_FOR_STEADY) && (len2 < _MAX_DISTANCE_RATIO_FOR_STEADY))
-        {
-            //hold stady, exit anyway
-            return;
-        }
-        if ((len1 < _MAX_DISTANCE_RATIO_FOR_STEADY) || (len2 < _MAX_DISTANCE_RATIO_FOR_STEADY))
-        {
-            //roc todo, buggy here
-            ResetCurrentGesture();
-            new (mCurrentGestureEvent) GestureRotateEvent(p1.x(), p1.y(), time, 2, 1.0f);
-        }
-        else
-        {
-            float dot = v0.DotProduct(v1);
-            if (dot > 0.0f)
-            {
-                //two tracks in the same direction, move
-                p0 = (p1 + p3) * 0.5f;
-                ResetCurrentGesture();
-                new (mCurrentGestureEvent) GestureMoveEvent(p0.x(), p0.y(), time, 2);
-                _inMultiTouchMove = true;
-                _lastMultiTouchMoveX = p0.x();
-                _lastMultiTouchMoveY = p0.y();
-            }
-            else
-            {
-                //pinch
-                ResetCurrentGesture();
-                new (mCurrentGestureEvent) GesturePinchEvent(p3.x(), p3.y(), time, 2, p1.DistanceSquared(p3) / p0.DistanceSquared(p2));
-            }
-        }
-        /*
-        int x, y;
-        temp[0]->GetTrackStartingPosition(x, y);
-        FastMath::Point3f p0 = {x, y, 0.0f};
-        temp[0]->GetTrackEndingPosition(x, y);
-        FastMath::Point3f p1 = {x, y, 0.0f};
-        temp[1]->GetTrackStartingPosition(x, y);
-        FastMath::Point3f p2 = {x, y, 0.0f};
-        temp[1]->GetTrackEndingPosition(x, y);
-        FastMath::Point3f p3 = {x, y, 0.0f};
-        FastMath::Point3f v1 = {p2[0] - p0[0], p2[1] - p0[1], 0.0f};
-        FastMath::Point3f v2 = {p3[0] - p1[0], p3[1] - p1[1], 0.0f};
-        float VectorAngleCos = 0.0f;
-        FastMath::VectorAngleCosine3f(v1, v2, &VectorAngleCos);
-        if(VectorAngleCos <= mMaxAngleCosValForRotate)
-        {
-            // rotate
-            float angle;
-            FastMath::FastArcCos(VectorAngleCos, &angle);
-            ResetCurrentGesture();
-            new (mCurrentGestureEvent) GestureRotateEvent(p3[0], p3[1], time, 2, angle);
-        }
-        else
-        {
-            float r1;
-            FastMath::VectorDistanceSqr3f(p0, p2, &r1);
-            float r2;
-            FastMath::VectorDistanceSqr3f(p1, p3, &r2);
-            // pinch
-            ResetCurrentGesture();
-            new (mCurrentGestureEvent) GesturePinchEvent(p3[0], p3[1], time, 2, r2/r1);
-        }
-        */
-    }
+    GestureStates<BaseGestureRecognizer>::OnMultiTouch(*this, time);
 }
 
 void BaseGestureRecognizer::Update(HexTime currentTime)
 {
-    unsigned int count = mChangedTouchQueues.Size();
-    if (GetActiveTouchQueueCount() > 1)
-    {
-        OnMultiTouch(currentTime);
-    }
-    else
-    {
-        if (_inMultiTouchMove)
-        {
-            ResetCurrentGesture();
-            new (mCurrentGestureEvent) GestureEndMoveEvent(_lastMultiTouchMoveX, _lastMultiTouchMoveY, currentTime, 2);
-            _lastMultiTouchMoveX = _lastMultiTouchMoveY = 0;
-            _inMultiTouchMove = false;
-        }
-        unsigned int idx = 0;
-        while (!mChangedTouchQueues.IsEmpty() && (idx < count))
-        {
-            BaseGestureRecognizer::TouchQueueInfomation info = mChangedTouchQueues.Pop();
-            idx ++;
-            int x, y;
-            info.touchQueue->GetTrackStartingPosition(x, y);
-            switch (info.curState)
-            {
-                case STATE_TAP:
-                    OnTapState(info, currentTime);
-                    break;
-                case STATE_SWIPE:
-                    OnSwipeState(info, currentTime);
-                    break;
-                case STATE_MOVE:
-                    OnMoveState(info, currentTime);
-                    break;
-                case STATE_LONG_TAP:
-                    OnLongTapState(info, currentTime);
-                    break;
-                case STATE_DOUBLE_TAP:
-                    OnDoubleTapState(info, currentTime);
-                    break;
-                case STATE_DRAG:
-                    OnDragState(info, currentTime);
-                    break;
-                case STATE_DRAG_MOVE:
-                    OnDragMoveState(info, currentTime);
-                    break;
-                case STATE_MULTI:
-                    info.touchQueue->ForceReleaseTouch();
-                    break;
-                case STATE_NONE:
-                    info.touchQueue->ForceReleaseTouch();
-                    break;
-                default:
-                    info.touchQueue->ForceReleaseTouch();
-                    break;
-            }
-        }
-    }
+    GestureStates<BaseGestureRecognizer>::Update(*this, currentTime);
 }
 
 unsigned int BaseGestureRecognizer::GetActiveTouchQueueCount()
 {
-    unsigned int count = mChangedTouchQueues.Size();
-    unsigned int val = 0;
-    for (int i = 0; i < count; ++i)
-    {
-        if (mChangedTouchQueues[i].touchQueue->IsActived())
-        {
-            val++;
-        }
-    }
-    return val;
+    return GestureStates<BaseGestureRecognizer>::GetActiveTouchQueueCount(*this);
 }
-
-
-
@@ -1,33 +1,66 @@
 #ifndef BASE_GESTURE_RECOGNIZER_H_
 #define BASE_GESTURE_RECOGNIZER_H_
 
-#include "HexmillEngine.h"
-#include "HexTimeCounter.h"
-#include "DS_Queue.h"
-#include "input/GestureEvents.h"
+#include "input/GesturePlatform.h"
+#include "input/GestureEventQueue.h"
+#include "input/GestureStats.h"
+#include "input/GestureTraceSink.h"
 
 class TouchQueue;
+template <class Machine> struct GestureStates;
 
 class BaseGestureRecognizer
 {
+    template <class Machine> friend struct GestureStates;
 public:
     BaseGestureRecognizer();
     virtual ~BaseGestureRecognizer();
 
     inline const char *GetId() const { return mId.c_str(); }
     
+    typedef BaseGestureRecognizer *(*Factory)();
+    //make a recognizer creatable by its id, returns false if the id is taken or the registry is full
+    static bool RegisterFactory(const char *id, Factory factory);
     static BaseGestureRecognizer *Create(const char *id);
     
     virtual void Initialize();
+    // initialize for an explicit screen size instead of the platform viewport (batch replay of recorded sessions)
+    virtual void Initialize(unsigned int viewportWidth, unsigned int viewportHeight);
     
-    virtual void ResetCurrentGesture();
-    inline BaseGestureEvent *GetCurrentGestureEvent() const { return mCurrentGestureEvent->IsValid() ? mCurrentGestureEvent : 0; }
+    // drops the state of every touch queue and the events, as created (the parameters stay), e.g. to reuse the
+    // recognizer for another session after TouchManager::ResetSession
+    virtual void Reset();
+
+    //every event recognized since the last clear, several contacts may resolve in the same Update
+    inline GestureEventQueue &GetGestureEvents() { return mGestureEvents; }
+    virtual void ClearGestureEvents();
+
+    // move and drag-move events carry the position of the contact horizon ms ahead (e.g. 16 to 32 for the
+    // display latency), extrapolated by the motion model of the track, 0 (default) for none, see TouchQueue::PredictPosition
+    inline void SetPredictionHorizon(HexTime horizon) { mPredictionHorizon = horizon; }
+
+    // state transitions go to the sink (not owned, 0 for none) under the given recognizer number, see TouchManager::SetTraceSink
+    inline void SetTraceSink(GestureTraceSink *sink, unsigned int traceId) { mTraceSink = sink; mTraceId = traceId; }
+
+#ifdef GESTURE_STATS
+    // handler counters since the last reset, TouchManager::GetStatsSnapshot sums them over its recognizers
+    inline const GestureRecognizerStats &GetStats() const { return mStats; }
+    inline void ResetStats() { mStats.Reset(); }
+#endif
     
     virtual void Update(HexTime currentTime);
     
 protected:
     std::string mId;
-    BaseGestureEvent *mCurrentGestureEvent;
+    GestureEventQueue mGestureEvents;
+#ifdef GESTURE_STATS
+    GestureRecognizerStats mStats;
+#endif
+    GestureTraceSink *mTraceSink;
+    unsigned int mTraceId;
+
+    //slot for the next recognized event, construct the event in it with placement new
+    inline BaseGestureEvent *NewGestureEvent() { return mGestureEvents.Push(); }
     
     HexTime mMaxIntervalOfDoubleClick;
     HexTime mMinSteadyTimeForDrag;
@@ -39,9 +72,38 @@ protected:
     float mMinYChangePersentForArc;
     int mMaxSteadyMoveDistanceX;
     int mMaxSteadyMoveDistanceY;
+    float mMaxDistanceRatioForSteady;
+    HexTime mPredictionHorizon;
+#ifdef GESTURE_FIXED_POINT
+    unsigned long long mMinSpeedSquaredForSwipe;
+    unsigned long long mMaxDistanceSquaredForSteady;
+#endif
+
+    //thresholds as the state machine reads them (see GestureStates.h), StaticGestureRecognizer hides them with constants
+    inline HexTime GetMaxIntervalOfDoubleClick() const { return mMaxIntervalOfDoubleClick; }
+    inline HexTime GetMinSteadyTimeForDrag() const { return mMinSteadyTimeForDrag; }
+    inline HexTime GetMinTimeForLongTap() const { return mMinTimeForLongTap; }
+    inline HexTime GetMaxSwipeDuration() const { return mMaxSwipeDuration; }
+    inline float GetMinSpeedForSwipe() const { return mMinSpeedForSwipe; }
+    inline int GetMinXDistanceForArc() const { return mMinXDistanceForArc; }
+    inline float GetMinYChangePersentForArc() const { return mMinYChangePersentForArc; }
+    inline int GetMaxSteadyMoveDistanceX() const { return mMaxSteadyMoveDistanceX; }
+    inline int GetMaxSteadyMoveDistanceY() const { return mMaxSteadyMoveDistanceY; }
+    inline float GetMaxDistanceRatioForSteady() const { return mMaxDistanceRatioForSteady; }
+    inline HexTime GetPredictionHorizon() const { return mPredictionHorizon; }
+#ifdef GESTURE_FIXED_POINT
+    //squared, in the integer units of TouchQueue::TrackFeatures
+    inline unsigned long long GetMinSpeedSquaredForSwipe() const { return mMinSpeedSquaredForSwipe; }
+    inline unsigned long long GetMaxDistanceSquaredForSteady() const { return mMaxDistanceSquaredForSteady; }
+#endif
+
+    //two finger move in progress, closed by an end move event once a single touch is left
+    bool mInMultiTouchMove;
+    int mLastMultiTouchMoveX;
+    int mLastMultiTouchMoveY;
 
 private:
-    void InitializeDefaultParameters();
+    void InitializeDefaultParameters(unsigned int width, unsigned int height);
 
 protected:
     
@@ -62,9 +124,10 @@ protected:
     
     struct TouchQueueInfomation
     {
-        TouchQueueInfomation() : touchQueue(0), releaseTime(0), lastChangingMode(0), repeatTimes(0) {}
+        TouchQueueInfomation() : touchQueue(0), releaseTime(0), lastChangingMode(0), repeatTimes(0), curState(STATE_NONE),
+                keep(false), prevChanged(0), nextChanged(0) {}
         TouchQueueInfomation(TouchQueue *queue, int changingMode, HexTime time) : touchQueue(queue), releaseTime(time), lastChangingMode(changingMode), repeatTimes(0),
-                curState(STATE_NONE)
+                curState(STATE_NONE), keep(false), prevChanged(0), nextChanged(0)
         {
             if (touchQueue->IsActived())
                 curState = STATE_TAP;
@@ -77,17 +140,65 @@ protected:
         int lastChangingMode;
         int repeatTimes;
         TouchState curState;
+
+        //set by the state handlers to track the queue in the next Update as well
+        bool keep;
+        //changed list links, slots of the neighbours
+        unsigned int prevChanged;
+        unsigned int nextChanged;
     };
     
+    enum { NO_CHANGED_SLOT = 0xffffffff };
+
+    //changing modes of TryAddTouchQueueChanging, the same values as TouchSample::SampleType
+    enum TouchQueueChangingMode
+    {
+        TQC_NONE        = 0,
+        TQC_PRESS       = 1,
+        TQC_MOVE        = 2,
+        TQC_RELEASE     = 3,
+    };
+
+    typedef TouchQueue TouchQueueType;
+    inline TouchQueue &GetTouchQueue(const TouchQueueInfomation &info) const { return *info.touchQueue; }
+
     TouchQueueInfomation &FindQueueInfomation(TouchQueue *queue);
     void TryRemoveTouchQueueInfomation(TouchQueue *queue);
+    inline void KeepTouchQueueInfomation(TouchQueueInfomation &info) { info.keep = true; }
+    inline void TraceTransition(unsigned int slot, TouchState from, TouchState to, HexTime time)
+    {
+        if (mTraceSink && (from != to))
+            mTraceSink->RecordTransition(mTraceId, slot, from, to, time);
+    }
     
-    DataStructures::Queue<TouchQueueInfomation> mChangedTouchQueues;
+    //dense per-slot state, indexed by TouchQueue::GetTouchIndex (the touch slot of TouchManager), grown on demand
+    //the changed queues are linked in the order they were pressed, the state handlers run in that order
+    TouchQueueInfomation *mTouchQueueInfomations;
+    unsigned int mTouchQueueInfomationCapacity;
+    unsigned int mFirstChanged;
+    unsigned int mLastChanged;
+    unsigned int mChangedCount;
+    bool mFixedTouchQueueInfomations;
     unsigned int GetActiveTouchQueueCount();
-    
+
+    //fixed state table of capacity slots (not owned), it is never grown
+    void UseTouchQueueInfomations(TouchQueueInfomation *infomations, unsigned int capacity);
+    void UnlinkChanged(unsigned int slot);
+
+public:
+    //size the per-slot state for slotCount touch slots up front, TouchManager does it on attach so a press never grows it
+    void ReserveTouchQueueInfomations(unsigned int slotCount);
+    //the recognizer still holds state for the touch slot (a contact in progress, a tap waiting for the double click)
+    inline bool IsTrackingTouchSlot(unsigned int slot) const
+    {
+        return (slot < mTouchQueueInfomationCapacity) && !mTouchQueueInfomations[slot].IsEmpty();
+    }
+private:
+    void FreeTouchQueueInfomations();
+    void LinkChanged(unsigned int slot);
     
 public:
-    bool TryAddTouchQueueChanging(TouchQueue *queue, int changingMode, HexTime time);
+    virtual bool TryAddTouchQueueChanging(TouchQueue *queue, int changingMode, HexTime time);
 
 protected:
     virtual void OnTapState(TouchQueueInfomation &info, HexTime time);
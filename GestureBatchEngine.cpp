@@ -0,0 +1,219 @@
+#include "input/GestureBatchEngine.h"
+#include "input/TouchManager.h"
+#include "input/BaseGestureRecognizer.h"
+#include "input/TouchTrace.h"
+
+// per worker, events of the first runs before the arena has grown to its working size
+static unsigned int _INITIAL_WORKER_EVENTS_     = 4096;
+
+//collects the events of one session into the arena of its worker
+class BatchEventCollector : public TouchManager::GestureListener
+{
+public:
+    BatchEventCollector(std::vector<BaseGestureEvent> &events) : mEvents(events) {}
+
+    virtual void GestureEvent(BaseGestureEvent *event) { mEvents.push_back(*event); }
+private:
+    std::vector<BaseGestureEvent> &mEvents;
+};
+
+//--------------------------------------------- GestureBatchEngine ---------------------------------------------
+GestureBatchEngine::GestureBatchEngine(unsigned int workerCount) : mWorkerCount(workerCount), mWorkerStorage(0), mWorkers(0), mSetup(0), mSetupUserData(0),
+        mTraces(0), mSessionCount(0), mStolenCount(0), mGeneration(0), mBusyWorkers(0), mStopping(false)
+{
+    if (!mWorkerCount)
+        mWorkerCount = std::thread::hardware_concurrency();
+    if (!mWorkerCount)
+        mWorkerCount = 1;
+    //the workers are cache line aligned, operator new [] does not promise that before C++17
+    mWorkerStorage = malloc(sizeof(Worker) * mWorkerCount + alignof(Worker));
+    mWorkers = (Worker *)(((size_t)mWorkerStorage + alignof(Worker) - 1) & ~(size_t)(alignof(Worker) - 1));
+    for (unsigned int i=0; i<mWorkerCount; i++)
+    {
+        new (&mWorkers[i]) Worker();
+        mWorkers[i].manager = 0;
+        mWorkers[i].collector = 0;
+        mWorkers[i].range.store(PackRange(0, 0), std::memory_order_relaxed);
+        mWorkers[i].events.reserve(_INITIAL_WORKER_EVENTS_);
+    }
+    //worker 0 is the thread calling Run
+    for (unsigned int i=1; i<mWorkerCount; i++)
+        mWorkers[i].thread = std::thread(&GestureBatchEngine::WorkerLoop, this, i);
+}
+
+GestureBatchEngine::~GestureBatchEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWakeUp.notify_all();
+    for (unsigned int i=1; i<mWorkerCount; i++)
+        mWorkers[i].thread.join();
+    DestroyWorkerManagers();
+    for (unsigned int i=0; i<mWorkerCount; i++)
+        mWorkers[i].~Worker();
+    free(mWorkerStorage);
+}
+
+void GestureBatchEngine::AddGestureRecognizer(const char *recognizerName)
+{
+    mRecognizerNames.push_back(recognizerName);
+    //the managers are built again with the new set
+    DestroyWorkerManagers();
+}
+
+void GestureBatchEngine::DestroyWorkerManagers()
+{
+    for (unsigned int i=0; i<mWorkerCount; i++)
+    {
+        delete mWorkers[i].manager;
+        delete mWorkers[i].collector;
+        mWorkers[i].manager = 0;
+        mWorkers[i].collector = 0;
+    }
+}
+
+void GestureBatchEngine::CreateWorkerManager(Worker &worker)
+{
+    worker.manager = new TouchManager();
+    if (mRecognizerNames.empty())
+        worker.manager->RegisterGestureRecognizer("BaseGestureRecognizer");
+    for (unsigned int i=0; i<mRecognizerNames.size(); i++)
+        worker.manager->RegisterGestureRecognizer(mRecognizerNames[i].c_str());
+    worker.collector = new BatchEventCollector(worker.events);
+    worker.manager->RegisterGestureListener(worker.collector);
+}
+
+void GestureBatchEngine::Run(const TouchTraceReader *const *traces, unsigned int count)
+{
+    mTraces = traces;
+    mSessionCount = count;
+    mResults.resize(count);
+    mStolenCount.store(0, std::memory_order_relaxed);
+    for (unsigned int i=0; i<mWorkerCount; i++)
+    {
+        mWorkers[i].events.clear();
+        unsigned int begin = (unsigned int)((unsigned long long)count * i / mWorkerCount);
+        unsigned int end = (unsigned int)((unsigned long long)count * (i + 1) / mWorkerCount);
+        mWorkers[i].range.store(PackRange(begin, end), std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBusyWorkers = mWorkerCount - 1;
+        mGeneration ++;
+    }
+    mWakeUp.notify_all();
+    ReplaySessions(0);
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mBusyWorkers)
+        mDone.wait(lock);
+    mTraces = 0;
+}
+
+const BaseGestureEvent *GestureBatchEngine::GetSessionEvents(unsigned int session, unsigned int &count) const
+{
+    count = 0;
+    if (session >= mSessionCount)
+        return 0;
+    const SessionResult &result = mResults[session];
+    count = result.count;
+    return count ? &mWorkers[result.worker].events[result.first] : 0;
+}
+
+void GestureBatchEngine::WorkerLoop(unsigned int index)
+{
+    unsigned int generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (!mStopping && (mGeneration == generation))
+                mWakeUp.wait(lock);
+            if (mStopping)
+                return;
+            generation = mGeneration;
+        }
+        ReplaySessions(index);
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mBusyWorkers == 0)
+            mDone.notify_one();
+    }
+}
+
+bool GestureBatchEngine::TakeOwnSession(Worker &worker, unsigned int &session)
+{
+    unsigned long long range = worker.range.load(std::memory_order_acquire);
+    for (;;)
+    {
+        unsigned int begin = (unsigned int)range;
+        unsigned int end = (unsigned int)(range >> 32);
+        if (begin >= end)
+            return false;
+        if (worker.range.compare_exchange_weak(range, PackRange(begin + 1, end), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            session = begin;
+            return true;
+        }
+    }
+}
+
+bool GestureBatchEngine::StealSessions(unsigned int thief, unsigned int &session)
+{
+    //the own range is empty here, so nobody else writes it: the stolen half is stored as the new own range
+    for (unsigned int i=1; i<mWorkerCount; i++)
+    {
+        Worker &victim = mWorkers[(thief + i) % mWorkerCount];
+        unsigned long long range = victim.range.load(std::memory_order_acquire);
+        for (;;)
+        {
+            unsigned int begin = (unsigned int)range;
+            unsigned int end = (unsigned int)(range >> 32);
+            if (begin >= end)
+                break;
+            unsigned int split = end - (end - begin + 1) / 2;
+            if (victim.range.compare_exchange_weak(range, PackRange(begin, split), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                mWorkers[thief].range.store(PackRange(split + 1, end), std::memory_order_release);
+                mStolenCount.fetch_add(end - split, std::memory_order_relaxed);
+                session = split;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void GestureBatchEngine::ReplaySessions(unsigned int index)
+{
+    unsigned int session;
+    while (TakeOwnSession(mWorkers[index], session) || StealSessions(index, session))
+        ReplaySession(index, session);
+}
+
+void GestureBatchEngine::ReplaySession(unsigned int index, unsigned int session)
+{
+    const TouchTraceReader *trace = mTraces[session];
+    Worker &worker = mWorkers[index];
+    if (!worker.manager)
+        CreateWorkerManager(worker);
+    TouchManager &manager = *worker.manager;
+    manager.ResetSession();
+    //a trace without a viewport runs with the platform one, not with the one of the previous session
+    for (unsigned int i=0; i<manager.GetGestureRecognizerCount(); i++)
+    {
+        if (trace->GetViewportWidth() && trace->GetViewportHeight())
+            manager.GetGestureRecognizer(i)->Initialize(trace->GetViewportWidth(), trace->GetViewportHeight());
+        else
+            manager.GetGestureRecognizer(i)->Initialize();
+    }
+    if (mSetup)
+        mSetup(&manager, mSetupUserData);
+
+    std::vector<BaseGestureEvent> &events = worker.events;
+    SessionResult &result = mResults[session];
+    result.worker = index;
+    result.first = events.size();
+    trace->Replay(&manager);
+    result.count = events.size() - result.first;
+}
@@ -0,0 +1,107 @@
+#ifndef GESTURE_BATCH_ENGINE_H_
+#define GESTURE_BATCH_ENGINE_H_
+
+#include "input/GestureEvents.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class TouchManager;
+class TouchTraceReader;
+class BatchEventCollector;
+
+//---------------------------- class for the parallel replay of recorded sessions ----------------------------
+// every session (a touch trace, see TouchTrace.h) is replayed on a pool of worker threads, every worker keeps one
+// TouchManager with its recognizers and resets it between the sessions (TouchManager::ResetSession), so a session
+// starts from the same state on any worker and the result does not depend on the scheduling:
+// the events of a session come back in the order they were recognized, the sessions in the order they were passed
+// work stealing: Run splits the sessions into one contiguous range per worker, a worker takes the sessions
+// from the front of its own range and, once it is empty, steals the back half of another range
+// every worker appends the events into its own arena, both it and the manager are kept over the runs, so the
+// sessions do not go to the shared allocator once they are warmed up, and nothing is locked while replaying
+class GestureBatchEngine
+{
+public:
+    // called on the worker thread for every session after the recognizers of the worker manager are reset and
+    // initialized for its viewport, e.g. to hand a PointCloudLibrary to the PointCloudRecognizer, it must be thread safe
+    typedef void (*SetupFunction)(TouchManager *manager, void *userData);
+
+    // workerCount: threads replaying, the calling thread of Run included, 0 for one per hardware thread
+    GestureBatchEngine(unsigned int workerCount = 0);
+    ~GestureBatchEngine();
+
+    inline unsigned int GetWorkerCount() const { return mWorkerCount; }
+
+    // recognizers registered by id in every worker manager, in this order, "BaseGestureRecognizer" if none is added
+    // not while running
+    void AddGestureRecognizer(const char *recognizerName);
+    inline void SetSetupFunction(SetupFunction setup, void *userData) { mSetup = setup; mSetupUserData = userData; }
+
+    // replays every trace (not owned, read only while running), blocks until all of them are done
+    void Run(const TouchTraceReader *const *traces, unsigned int count);
+
+    // results of the last Run, valid until the next one
+    inline unsigned int GetSessionCount() const { return mSessionCount; }
+    // events of one session in recognition order, 0 if there is none
+    const BaseGestureEvent *GetSessionEvents(unsigned int session, unsigned int &count) const;
+    // sessions replayed by another worker than the one they were assigned to
+    inline unsigned int GetStolenSessionCount() const { return mStolenCount.load(std::memory_order_relaxed); }
+
+private:
+    GestureBatchEngine(const GestureBatchEngine &);
+    GestureBatchEngine &operator = (const GestureBatchEngine &);
+
+    struct SessionResult
+    {
+        unsigned int worker;
+        unsigned int first;
+        unsigned int count;
+    };
+
+    // one per worker, on its own cache lines: the range is written by the owner and by the thieves
+    struct alignas(64) Worker
+    {
+        // begin in the low, end in the high 32 bits, both sides take sessions with a compare and swap
+        std::atomic<unsigned long long> range;
+        std::vector<BaseGestureEvent> events;
+        // created by the worker for its first session
+        TouchManager *manager;
+        BatchEventCollector *collector;
+        std::thread thread;
+    };
+
+    static inline unsigned long long PackRange(unsigned int begin, unsigned int end)
+    {
+        return ((unsigned long long)end << 32) | begin;
+    }
+    bool TakeOwnSession(Worker &worker, unsigned int &session);
+    bool StealSessions(unsigned int thief, unsigned int &session);
+    void WorkerLoop(unsigned int index);
+    void ReplaySessions(unsigned int index);
+    void ReplaySession(unsigned int index, unsigned int session);
+    void CreateWorkerManager(Worker &worker);
+    void DestroyWorkerManagers();
+
+    unsigned int mWorkerCount;
+    void *mWorkerStorage;
+    Worker *mWorkers;
+    std::vector<std::string> mRecognizerNames;
+    SetupFunction mSetup;
+    void *mSetupUserData;
+
+    const TouchTraceReader *const *mTraces;
+    unsigned int mSessionCount;
+    std::vector<SessionResult> mResults;
+    std::atomic<unsigned int> mStolenCount;
+
+    // the pool wakes up for every Run (a new generation), Run returns once every helper is done
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::condition_variable mDone;
+    unsigned int mGeneration;
+    unsigned int mBusyWorkers;
+    bool mStopping;
+};
+
+#endif
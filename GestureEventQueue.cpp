@@ -0,0 +1,63 @@
+#include "input/GestureEventQueue.h"
+#include "input/GestureMemory.h"
+
+//----------------------------------------------- GestureEventQueue -----------------------------------------------
+GestureEventQueue::GestureEventQueue(unsigned int capacity) : mCapacity(capacity), mHead(0), mSize(0), mDroppedCount(0)
+{
+    assert(mCapacity >= 1);
+    mEvents = (BaseGestureEvent *)GestureMemory::Allocate(sizeof(BaseGestureEvent) * (mCapacity + 1));
+    for (unsigned int i=0; i<=mCapacity; i++)
+        new (mEvents + i) BaseGestureEvent();
+}
+
+GestureEventQueue::~GestureEventQueue()
+{
+    for (unsigned int i=0; i<=mCapacity; i++)
+        mEvents[i].~BaseGestureEvent();
+    GestureMemory::Free(mEvents);
+}
+
+BaseGestureEvent *GestureEventQueue::Push()
+{
+    BaseGestureEvent *event;
+    if (mSize == mCapacity)
+    {
+        mDroppedCount ++;
+        event = &mEvents[mCapacity];
+    }
+    else
+    {
+        unsigned int slot = mHead + mSize;
+        event = &mEvents[slot >= mCapacity ? slot - mCapacity : slot];
+        mSize ++;
+    }
+    return event;
+}
+
+unsigned int GestureEventQueue::CopyTo(BaseGestureEvent *events, unsigned int maxCount) const
+{
+    unsigned int count = mSize < maxCount ? mSize : maxCount;
+    unsigned int first = mCapacity - mHead;
+    if (first > count)
+        first = count;
+    memcpy(events, mEvents + mHead, sizeof(BaseGestureEvent) * first);
+    memcpy(events + first, mEvents, sizeof(BaseGestureEvent) * (count - first));
+    return count;
+}
+
+BaseGestureEvent *GestureEventQueue::Pop()
+{
+    if (mSize == 0)
+        return 0;
+    BaseGestureEvent *event = &mEvents[mHead];
+    if (++mHead == mCapacity)
+        mHead = 0;
+    mSize --;
+    return event;
+}
+
+void GestureEventQueue::Clear()
+{
+    mHead = 0;
+    mSize = 0;
+}
@@ -0,0 +1,50 @@
+#ifndef GESTURE_EVENT_QUEUE_H_
+#define GESTURE_EVENT_QUEUE_H_
+
+#include "input/GestureEvents.h"
+
+//---------------------------- fixed capacity ring of gesture events ----------------------------
+// the recognizer fills it during Update, TouchManager drains it to the listeners in one batch
+// all slots are allocated once, an event is constructed in its slot: new (queue.Push()) GestureTapEvent(...)
+// the events are plain records, nothing is destroyed when a slot is reused
+class GestureEventQueue
+{
+public:
+    GestureEventQueue(unsigned int capacity);
+    ~GestureEventQueue();
+
+    // slot for a new event at the tail, the caller constructs the event in it
+    // when the queue is full the event is dropped: a scratch slot is returned and the drop is counted
+    BaseGestureEvent *Push();
+    inline void Push(const BaseGestureEvent &event) { *Push() = event; }
+    // removes the oldest event, the returned slot stays valid until the next Push
+    BaseGestureEvent *Pop();
+    void Clear();
+
+    inline unsigned int Size() const { return mSize; }
+    inline bool IsEmpty() const { return mSize == 0; }
+    inline unsigned int GetCapacity() const { return mCapacity; }
+    inline unsigned int GetDroppedCount() const { return mDroppedCount; }
+
+    // copies up to maxCount pending events, the oldest first, returns the number copied
+    unsigned int CopyTo(BaseGestureEvent *events, unsigned int maxCount) const;
+
+    // pending events, the oldest first
+    inline BaseGestureEvent *operator [] (unsigned int index) const
+    {
+        assert(index < mSize);
+        unsigned int slot = mHead + index;
+        return &mEvents[slot >= mCapacity ? slot - mCapacity : slot];
+    }
+private:
+    GestureEventQueue(const GestureEventQueue &);
+    GestureEventQueue &operator = (const GestureEventQueue &);
+
+    BaseGestureEvent *mEvents;      // mCapacity slots plus the scratch slot
+    unsigned int mCapacity;
+    unsigned int mHead;
+    unsigned int mSize;
+    unsigned int mDroppedCount;
+};
+
+#endif
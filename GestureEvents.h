@@ -2,6 +2,7 @@
 #define BASE_GESTURE_EVENTS_H_
 
 #include "input/TouchQueue.h"
+#include <type_traits>
 
 #define GESTURE_UNKNOWN         0
 #define GESTURE_BEGIN_MOVE      1
@@ -17,20 +18,28 @@
 #define GESTURE_DROP            11
 #define GESTURE_PINCH           12
 #define GESTURE_ROTATE          13
+#define GESTURE_SHAPE           14
+
+// subscription masks of TouchManager::RegisterGestureListener, event types below GESTURE_MAX_TYPES
+#define GESTURE_MAX_TYPES       32
+#define GESTURE_MASK(type)      (1u << (type))
+#define GESTURE_MASK_ALL        0xffffffffu
 
 //---------------------------- class for basic gesture event ----------------------------
 // note: the BaseGestureEvent includes all data, DO NOT introduce ANY DATA in the sub class(es)
 // so, we can using new (eventInstance) GestureXXXEvent without any memory-fragment
+// no virtual function either: the events are trivially copyable 24 byte records (memcpy into queues, logs and snapshots),
+// the sub classes only add the typed constructors and accessors, the type tag tells which one applies
 class BaseGestureEvent
 {
 public:
-    BaseGestureEvent() : mEventX(0), mEventY(0), mEventTime(0), mTouchCount(1), mEventType(GESTURE_UNKNOWN), mFloatParameter(0.0f), mIntParameter(0)
+    BaseGestureEvent() : mEventTime(0), mEventX(0), mEventY(0), mFloatParameter(0.0f), mIntParameter(0), mIntParameter1(0),
+            mEventType(GESTURE_UNKNOWN), mTouchCount(1)
     {}
     
-    BaseGestureEvent(int x, int y, HexTime time, unsigned int touchCount) : mEventX(x), mEventY(y), mEventTime(time), mTouchCount(touchCount), mEventType(GESTURE_UNKNOWN), mFloatParameter(0.0f), mIntParameter(0), mIntParameter1(0)
+    BaseGestureEvent(int x, int y, HexTime time, unsigned int touchCount) : mEventTime(static_cast<__u32>(time)), mEventX(x), mEventY(y),
+            mFloatParameter(0.0f), mIntParameter(0), mIntParameter1(0), mEventType(GESTURE_UNKNOWN), mTouchCount(static_cast<__u8>(touchCount))
     {}
-    
-    virtual ~BaseGestureEvent() {}
 
     inline const __u8 GetEventType() const { return mEventType; }
     
@@ -38,21 +47,37 @@ public:
     inline const int GetEventY() const { return mEventY; }
     inline void GetEventCoordinate(int &x, int &y) const { x = mEventX; y = mEventY; }
     
-    inline const HexTime GetEventTime() const { return mEventTime; }
+    inline const HexTime GetEventTime() const { return static_cast<HexTime>(mEventTime); }
     inline const unsigned int GetTouchCount() const { return mTouchCount; }
     
-    virtual inline bool IsValid() const { return false; }
+    inline bool IsValid() const { return mEventType != GESTURE_UNKNOWN; }
 protected:
-    __u8 mEventType;
+    // a position in mIntParameter (16 bits per coordinate) and a time in mIntParameter1, 0 for none
+    // the coordinates are clamped to [-32768, 32767] and the horizon to 65535 ms, they do not wrap
+    inline void SetPrediction(int x, int y, HexTime horizon)
+    {
+        if (!horizon)
+            return;
+        mIntParameter = static_cast<__u32>(static_cast<__u16>(ClampToShort(x))) | (static_cast<__u32>(static_cast<__u16>(ClampToShort(y))) << 16);
+        mIntParameter1 = static_cast<__u16>(horizon > 0xffff ? 0xffff : horizon);
+    }
+    static inline int ClampToShort(int value) { return value < -32768 ? -32768 : (value > 32767 ? 32767 : value); }
+    inline int GetPackedX() const { return static_cast<short>(mIntParameter & 0xffff); }
+    inline int GetPackedY() const { return static_cast<short>(mIntParameter >> 16); }
+
+    __u32 mEventTime;
     int mEventX;
     int mEventY;
-    unsigned int mTouchCount;
-    HexTime mEventTime;
     float mFloatParameter;
     __u32 mIntParameter;
-    __u32 mIntParameter1;
+    __u16 mIntParameter1;
+    __u8 mEventType;
+    __u8 mTouchCount;
 };
 
+static_assert(sizeof(BaseGestureEvent) == 24, "BaseGestureEvent is a packed 24 byte record");
+static_assert(std::is_trivially_copyable<BaseGestureEvent>::value, "BaseGestureEvent must stay memcpy-able");
+
 //---------------------------- class for tap gesture event ----------------------------
 class GestureTapEvent : public BaseGestureEvent
 {
@@ -61,8 +86,6 @@ public:
     {
         mEventType = GESTURE_TAP;
     }
-
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for long-tap gesture event ----------------------------
@@ -76,8 +99,6 @@ public:
     }
     
     inline const HexTime GetDuration() const { return static_cast<HexTime>(mIntParameter); }
-
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for double-click gesture event ----------------------------
@@ -88,8 +109,6 @@ public:
     {
         mEventType = GESTURE_DOUBLE_CLICK;
     }
-
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for swipe gesture event ----------------------------
@@ -103,8 +122,6 @@ public:
     }
     
     inline const TouchQueue::Direction GetDirection() const { return static_cast<TouchQueue::Direction>(mIntParameter); }
-
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for arc gesture event ----------------------------
@@ -115,13 +132,11 @@ public:
     {
         mEventType = GESTURE_ARC;
         mIntParameter = static_cast<__u32>(arcShape);
-        mIntParameter1 = static_cast<__u32>(direction);
+        mIntParameter1 = static_cast<__u16>(direction);
     }
 
     inline const TouchQueue::ArcShape GetArcShape() const { return static_cast<TouchQueue::ArcShape>(mIntParameter); }
     inline const TouchQueue::Direction GetDirection() const { return static_cast<TouchQueue::Direction>(mIntParameter1); }
-    
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for move gesture event ----------------------------
@@ -132,8 +147,19 @@ public:
     {
         mEventType = GESTURE_MOVE;
     }
-    
-    virtual inline bool IsValid() const { return true; }
+    GestureMoveEvent(int x, int y, HexTime time, unsigned int touchCount, int predictedX, int predictedY, HexTime horizon) :
+            BaseGestureEvent(x, y, time, touchCount)
+    {
+        mEventType = GESTURE_MOVE;
+        SetPrediction(predictedX, predictedY, horizon);
+    }
+
+    // predicted position, see BaseGestureRecognizer::SetPredictionHorizon
+    // packed in 16 bits per coordinate: a prediction outside [-32768, 32767] is clamped to the range
+    inline bool HasPrediction() const { return mIntParameter1 != 0; }
+    inline const int GetPredictedX() const { return HasPrediction() ? GetPackedX() : mEventX; }
+    inline const int GetPredictedY() const { return HasPrediction() ? GetPackedY() : mEventY; }
+    inline const HexTime GetPredictionHorizon() const { return static_cast<HexTime>(mIntParameter1); }
 };
 
 //---------------------------- class for end move gesture event ----------------------------
@@ -144,8 +170,6 @@ public:
     {
         mEventType = GESTURE_END_MOVE;
     }
-    
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for drag gesture event ----------------------------
@@ -156,8 +180,6 @@ public:
     {
         mEventType = GESTURE_DRAG;
     }
-
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for drag-move gesture event ----------------------------
@@ -168,8 +190,19 @@ public:
     {
         mEventType = GESTURE_DRAG_MOVE;
     }
+    GestureDragMoveEvent(int x, int y, HexTime time, unsigned int touchCount, int predictedX, int predictedY, HexTime horizon) :
+            BaseGestureEvent(x, y, time, touchCount)
+    {
+        mEventType = GESTURE_DRAG_MOVE;
+        SetPrediction(predictedX, predictedY, horizon);
+    }
 
-    virtual inline bool IsValid() const { return true; }
+    // predicted position, see BaseGestureRecognizer::SetPredictionHorizon
+    // packed in 16 bits per coordinate: a prediction outside [-32768, 32767] is clamped to the range
+    inline bool HasPrediction() const { return mIntParameter1 != 0; }
+    inline const int GetPredictedX() const { return HasPrediction() ? GetPackedX() : mEventX; }
+    inline const int GetPredictedY() const { return HasPrediction() ? GetPackedY() : mEventY; }
+    inline const HexTime GetPredictionHorizon() const { return static_cast<HexTime>(mIntParameter1); }
 };
 
 //---------------------------- class for drop gesture event ----------------------------
@@ -180,8 +213,6 @@ public:
     {
         mEventType = GESTURE_DROP;
     }
-
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for pinch gesture event ----------------------------
@@ -195,8 +226,6 @@ public:
     }
     
     inline const float GetScale() const { return mFloatParameter; }
-
-    virtual inline bool IsValid() const { return true; }
 };
 
 //---------------------------- class for rotate gesture event ----------------------------
@@ -210,8 +239,22 @@ public:
     }
     
     inline const float GetAngle() const { return mFloatParameter; }
+};
+
+//---------------------------- class for shape gesture event ----------------------------
+// a template of the PointCloudLibrary matched at the release of the strokes, see PointCloudRecognizer
+class GestureShapeEvent : public BaseGestureEvent
+{
+public:
+    GestureShapeEvent(int x, int y, HexTime time, unsigned int touchCount, unsigned int templateIndex, float score) : BaseGestureEvent(x, y, time, touchCount)
+    {
+        mEventType = GESTURE_SHAPE;
+        mIntParameter = static_cast<__u32>(templateIndex);
+        mFloatParameter = score;
+    }
 
-    virtual inline bool IsValid() const { return true; }
+    inline const unsigned int GetTemplateIndex() const { return mIntParameter; }
+    inline const float GetScore() const { return mFloatParameter; }
 };
 
 #endif
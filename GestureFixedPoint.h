@@ -0,0 +1,57 @@
+#ifndef GESTURE_FIXED_POINT_H_
+#define GESTURE_FIXED_POINT_H_
+
+// note: integer helpers of the deterministic build (GESTURE_FIXED_POINT, see README)
+// with it, every recognizer decision (swipe speed, steady distance, arc and pinch tests) is taken on 64 bit integers
+// from the integer screen coordinates and millisecond times, so a trace gives the same events on every platform
+// the policy ratios are turned into millionths at compile time, the float event payloads are converted from
+// fixed point values (exactly rounded everywhere)
+// bounds: coordinates within +-32767 (the range of the touch traces), segment times below 32768 ms
+namespace FixedPoint
+{
+    static const long long MILLION      = 1000000;
+    static const int Q16_SHIFT          = 16;
+    static const long long Q16_ONE      = 1 << Q16_SHIFT;
+
+    // ratio of the policy in millionths, rounded to the nearest
+    static constexpr long long ToMillionths(double value)
+    {
+        return (long long)(value * 1000000.0 + ((value < 0.0) ? -0.5 : 0.5));
+    }
+
+    static constexpr unsigned long long CeilDivide(unsigned long long value, unsigned long long divisor)
+    {
+        return (value + divisor - 1) / divisor;
+    }
+
+    // (value * millionths / 10^6) rounded to the nearest, value >= 0
+    static constexpr long long ScaleMillionths(long long value, long long millionths)
+    {
+        return (value * millionths + MILLION / 2) / MILLION;
+    }
+
+    // floor(|d|^2 * 10^6 / dt^2), the squared speed in pixels per second of a segment, dt != 0
+    static inline unsigned long long SegmentSpeedSquared(long long dx, long long dy, long long dt)
+    {
+        if (dt < 0)
+            dt = -dt;
+        if (dt > 32767)
+            dt = 32767;
+        return (unsigned long long)((dx * dx + dy * dy) * MILLION) / (unsigned long long)(dt * dt);
+    }
+
+    // ceil of the squared swipe speed threshold: the screen diagonal per durationMillionths of a second
+    static constexpr unsigned long long SwipeSpeedSquared(unsigned long long width, unsigned long long height, long long durationMillionths)
+    {
+        return CeilDivide((width * width + height * height) * MILLION,
+                (unsigned long long)((durationMillionths + 500) / 1000) * (unsigned long long)((durationMillionths + 500) / 1000));
+    }
+
+    // smallest squared integer length that is not below ratioMillionths / 10^6: ceil(ratio^2)
+    static constexpr unsigned long long SquaredLengthThreshold(long long ratioMillionths)
+    {
+        return CeilDivide((unsigned long long)ratioMillionths * (unsigned long long)ratioMillionths, (unsigned long long)MILLION * MILLION);
+    }
+}
+
+#endif
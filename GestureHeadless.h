@@ -0,0 +1,232 @@
+#ifndef GESTURE_HEADLESS_H_
+#define GESTURE_HEADLESS_H_
+
+// note: minimal stand-ins for the engine types used by the gesture core, only compiled with GESTURE_HEADLESS
+// keep the names and signatures identical to HexmillEngine / DS_Queue, so the core sources build unchanged
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef SAFE_DELETE
+#define SAFE_DELETE(p)          do { if (p) { delete (p); (p) = 0; } } while (0)
+#endif
+
+typedef unsigned char           __u8;
+typedef unsigned short          __u16;
+typedef unsigned int            __u32;
+
+namespace HexmillEngine
+{
+    // milliseconds
+    typedef unsigned int HexTime;
+
+    namespace FastMath
+    {
+        //---------------------------- Vector2 ----------------------------
+        class Vector2
+        {
+        public:
+            Vector2() { mV[0] = mV[1] = 0.0f; }
+            Vector2(float x, float y) { mV[0] = x; mV[1] = y; }
+
+            static inline Vector2 Zero() { return Vector2(0.0f, 0.0f); }
+
+            inline float &x() { return mV[0]; }
+            inline float &y() { return mV[1]; }
+            inline float x() const { return mV[0]; }
+            inline float y() const { return mV[1]; }
+
+            inline Vector2 operator + (const Vector2 &v) const { return Vector2(mV[0] + v.mV[0], mV[1] + v.mV[1]); }
+            inline Vector2 operator - (const Vector2 &v) const { return Vector2(mV[0] - v.mV[0], mV[1] - v.mV[1]); }
+            inline Vector2 operator * (float s) const { return Vector2(mV[0] * s, mV[1] * s); }
+
+            inline bool IsZero() const { return (mV[0] == 0.0f) && (mV[1] == 0.0f); }
+            inline float LengthSquared() const { return mV[0] * mV[0] + mV[1] * mV[1]; }
+            inline float Length() const { return sqrtf(LengthSquared()); }
+            inline float DotProduct(const Vector2 &v) const { return mV[0] * v.mV[0] + mV[1] * v.mV[1]; }
+            inline void Normalize()
+            {
+                float len = Length();
+                if (len > 0.0f)
+                {
+                    mV[0] /= len;
+                    mV[1] /= len;
+                }
+            }
+        private:
+            float mV[2];
+        };
+
+        //---------------------------- Vector3 ----------------------------
+        class Vector3
+        {
+        public:
+            Vector3() { mV[0] = mV[1] = mV[2] = 0.0f; }
+            Vector3(float x, float y, float z) { mV[0] = x; mV[1] = y; mV[2] = z; }
+
+            inline float &x() { return mV[0]; }
+            inline float &y() { return mV[1]; }
+            inline float &z() { return mV[2]; }
+            inline float x() const { return mV[0]; }
+            inline float y() const { return mV[1]; }
+            inline float z() const { return mV[2]; }
+
+            inline Vector3 operator + (const Vector3 &v) const { return Vector3(mV[0] + v.mV[0], mV[1] + v.mV[1], mV[2] + v.mV[2]); }
+            inline Vector3 operator - (const Vector3 &v) const { return Vector3(mV[0] - v.mV[0], mV[1] - v.mV[1], mV[2] - v.mV[2]); }
+            inline Vector3 operator * (float s) const { return Vector3(mV[0] * s, mV[1] * s, mV[2] * s); }
+
+            inline float DotProduct(const Vector3 &v) const { return mV[0] * v.mV[0] + mV[1] * v.mV[1] + mV[2] * v.mV[2]; }
+            inline float Length() const { return sqrtf(DotProduct(*this)); }
+            inline float DistanceSquared(const Vector3 &v) const { Vector3 d = *this - v; return d.DotProduct(d); }
+        private:
+            float mV[3];
+        };
+    }
+}
+
+namespace DataStructures
+{
+    //---------------------------- Queue ----------------------------
+    // ring buffer with the same interface as the engine's DS_Queue
+    template <class queue_type>
+    class Queue
+    {
+    public:
+        Queue() : array(0), head(0), tail(0), allocation_size(0) {}
+        ~Queue() { if (allocation_size > 0) delete [] array; }
+
+        Queue(const Queue &original) : array(0), head(0), tail(0), allocation_size(0)
+        {
+            *this = original;
+        }
+
+        Queue &operator = (const Queue &original)
+        {
+            if (this == &original)
+                return *this;
+            Clear();
+            unsigned int count = original.Size();
+            if (count == 0)
+                return *this;
+            ClearAndForceAllocation(count + 1);
+            for (unsigned int i=0; i<count; i++)
+                array[i] = original[i];
+            tail = count;
+            return *this;
+        }
+
+        inline unsigned int Size() const
+        {
+            if (head <= tail)
+                return tail - head;
+            return allocation_size - head + tail;
+        }
+        inline bool IsEmpty() const { return head == tail; }
+        inline unsigned int AllocationSize() const { return allocation_size; }
+
+        void Push(const queue_type &input)
+        {
+            if (allocation_size == 0)
+                ClearAndForceAllocation(16);
+            array[tail++] = input;
+            if (tail == allocation_size)
+                tail = 0;
+            if (tail == head)
+                Grow();
+        }
+
+        inline queue_type Pop()
+        {
+            assert(head != tail);
+            unsigned int index = head;
+            if (++head == allocation_size)
+                head = 0;
+            return array[index];
+        }
+
+        inline queue_type Peek() const
+        {
+            assert(head != tail);
+            return array[head];
+        }
+
+        inline queue_type PeekTail() const
+        {
+            assert(head != tail);
+            return array[tail != 0 ? tail - 1 : allocation_size - 1];
+        }
+
+        inline queue_type &operator [] (unsigned int position)
+        {
+            assert(position < Size());
+            unsigned int index = head + position;
+            return array[index >= allocation_size ? index - allocation_size : index];
+        }
+
+        inline const queue_type &operator [] (unsigned int position) const
+        {
+            assert(position < Size());
+            unsigned int index = head + position;
+            return array[index >= allocation_size ? index - allocation_size : index];
+        }
+
+        void RemoveAtIndex(unsigned int position)
+        {
+            assert(position < Size());
+            unsigned int count = Size();
+            for (unsigned int i=position; i+1<count; i++)
+                (*this)[i] = (*this)[i + 1];
+            tail = (tail == 0) ? allocation_size - 1 : tail - 1;
+        }
+
+        void Clear()
+        {
+            if (allocation_size > 32)
+            {
+                delete [] array;
+                array = 0;
+                allocation_size = 0;
+            }
+            head = tail = 0;
+        }
+
+        void ClearAndForceAllocation(unsigned int size)
+        {
+            if (allocation_size > 0)
+                delete [] array;
+            array = 0;
+            allocation_size = 0;
+            head = tail = 0;
+            if (size > 0)
+            {
+                array = new queue_type[size];
+                allocation_size = size;
+            }
+        }
+
+    private:
+        void Grow()
+        {
+            queue_type *newArray = new queue_type[allocation_size * 2];
+            for (unsigned int i=0; i<allocation_size; i++)
+                newArray[i] = array[(head + i) % allocation_size];
+            head = 0;
+            tail = allocation_size;
+            allocation_size *= 2;
+            delete [] array;
+            array = newArray;
+        }
+
+        queue_type *array;
+        unsigned int head;
+        unsigned int tail;
+        unsigned int allocation_size;
+    };
+}
+
+#endif
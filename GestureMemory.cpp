@@ -0,0 +1,54 @@
+#include "input/GestureMemory.h"
+#include <atomic>
+
+static void *_MallocAllocate(size_t size, void *)
+{
+    return malloc(size);
+}
+
+static void _MallocRelease(void *block, void *)
+{
+    free(block);
+}
+
+static GestureMemory::Hooks _hooks = { _MallocAllocate, _MallocRelease, 0 };
+static std::atomic<unsigned long long> _allocation_count(0);
+
+//------------------------------------------------ GestureMemory ------------------------------------------------
+void GestureMemory::SetHooks(const Hooks *hooks)
+{
+    if (hooks)
+    {
+        assert(hooks->allocate && hooks->release);
+        _hooks = *hooks;
+        return;
+    }
+    _hooks.allocate = _MallocAllocate;
+    _hooks.release = _MallocRelease;
+    _hooks.context = 0;
+}
+
+void *GestureMemory::Allocate(size_t size)
+{
+    _allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return _hooks.allocate(size ? size : 1, _hooks.context);
+}
+
+void *GestureMemory::AllocateZeroed(size_t count, size_t size)
+{
+    void *block = Allocate(count * size);
+    if (block)
+        memset(block, 0, count * size);
+    return block;
+}
+
+void GestureMemory::Free(void *block)
+{
+    if (block)
+        _hooks.release(block, _hooks.context);
+}
+
+unsigned long long GestureMemory::GetAllocationCount()
+{
+    return _allocation_count.load(std::memory_order_relaxed);
+}
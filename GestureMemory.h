@@ -0,0 +1,35 @@
+#ifndef GESTURE_MEMORY_H_
+#define GESTURE_MEMORY_H_
+
+#include "input/GesturePlatform.h"
+
+// note: heap blocks of the gesture core (track storage and arenas, sample and event rings, recognizer event queues
+// and slot tables, slot maps, trace sink) go through GestureMemory, so the application can route them to its own
+// allocator and tests and benchmarks can count them. The manager and recognizer tables are sized on attach, the
+// tracks take their storage from the arena of the manager and give it back on release. So as long as the arena
+// holds the contacts in flight, TouchManager::Update and the input callbacks allocate nothing once warmed up,
+// GetAllocationCount stays flat (see README "Zero allocation updates"), a track the arena can not hold allocates
+// the objects the core creates with new (managers, recognizers) go through the global operator new
+namespace GestureMemory
+{
+    struct Hooks
+    {
+        void *(*allocate)(size_t size, void *context);
+        void (*release)(void *block, void *context);
+        void *context;
+    };
+
+    // hooks 0 restores malloc / free
+    // install them before the first TouchManager is created and keep them until the last one is gone,
+    // a block goes back to the hooks that allocated it
+    void SetHooks(const Hooks *hooks);
+
+    void *Allocate(size_t size);
+    void *AllocateZeroed(size_t count, size_t size);
+    void Free(void *block);
+
+    // blocks allocated since the start, from any thread
+    unsigned long long GetAllocationCount();
+}
+
+#endif
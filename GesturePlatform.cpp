@@ -0,0 +1,99 @@
+#include "input/GesturePlatform.h"
+
+#ifdef GESTURE_HEADLESS
+#include <chrono>
+#endif
+
+static unsigned int _viewport_width_override    = 0;
+static unsigned int _viewport_height_override   = 0;
+
+#ifdef GESTURE_HEADLESS
+static const unsigned int _DEFAULT_VIEWPORT_WIDTH_  = 1280;
+static const unsigned int _DEFAULT_VIEWPORT_HEIGHT_ = 720;
+
+static unsigned long long _GetTickMilliseconds()
+{
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+//------------------------------------------------ GestureViewport ------------------------------------------------
+void GestureViewport::GetSize(unsigned int &width, unsigned int &height)
+{
+    if (_viewport_width_override && _viewport_height_override)
+    {
+        width = _viewport_width_override;
+        height = _viewport_height_override;
+        return;
+    }
+#ifdef GESTURE_HEADLESS
+    width = _DEFAULT_VIEWPORT_WIDTH_;
+    height = _DEFAULT_VIEWPORT_HEIGHT_;
+#else
+    width = Game::GetInstance()->GetViewport().width;
+    height = Game::GetInstance()->GetViewport().height;
+#endif
+}
+
+void GestureViewport::SetSize(unsigned int width, unsigned int height)
+{
+    _viewport_width_override = width;
+    _viewport_height_override = height;
+}
+
+//-------------------------------------------------- GestureClock -------------------------------------------------
+#ifndef GESTURE_HEADLESS
+GestureClock::GestureClock() : mManualTime(0), mManual(false), mStopped(true)
+{
+    mCounter.StopTimer();
+}
+
+void GestureClock::StartTimer()
+{
+    mCounter.StartTimer();
+    mStopped.store(false, std::memory_order_release);
+}
+
+void GestureClock::StopTimer()
+{
+    mStopped.store(true, std::memory_order_release);
+    mCounter.StopTimer();
+}
+
+HexTime GestureClock::GetTimeSlapped() const
+{
+    if (mManual.load(std::memory_order_acquire))
+        return mManualTime.load(std::memory_order_relaxed);
+    return const_cast<HexTimeCounter &>(mCounter).GetTimeSlapped();
+}
+#else
+GestureClock::GestureClock() : mStartTick(0), mManualTime(0), mManual(false), mStopped(true)
+{
+}
+
+void GestureClock::StartTimer()
+{
+    mStartTick.store(_GetTickMilliseconds(), std::memory_order_relaxed);
+    mStopped.store(false, std::memory_order_release);
+}
+
+void GestureClock::StopTimer()
+{
+    mStopped.store(true, std::memory_order_release);
+}
+
+HexTime GestureClock::GetTimeSlapped() const
+{
+    if (mManual.load(std::memory_order_acquire))
+        return mManualTime.load(std::memory_order_relaxed);
+    if (mStopped.load(std::memory_order_acquire))
+        return 0;
+    return (HexTime)(_GetTickMilliseconds() - mStartTick.load(std::memory_order_relaxed));
+}
+#endif
+
+void GestureClock::SetManualTime(HexTime time)
+{
+    mManualTime.store(time, std::memory_order_relaxed);
+    mManual.store(true, std::memory_order_release);
+}
@@ -0,0 +1,65 @@
+#ifndef GESTURE_PLATFORM_H_
+#define GESTURE_PLATFORM_H_
+
+// note: the ONLY place where the gesture core touches the engine
+// define GESTURE_HEADLESS to build the core without HexmillEngine (server side batch replay, tools)
+
+#ifdef GESTURE_HEADLESS
+#include "input/GestureHeadless.h"
+#else
+#include "HexmillEngine.h"
+#include "HexTimeCounter.h"
+#include "DS_Queue.h"
+#include <new>
+#include <string>
+#include <vector>
+#endif
+#include <atomic>
+
+using namespace HexmillEngine;
+
+//---------------------------- viewport shim ----------------------------
+class GestureViewport
+{
+public:
+    // size of the screen the touches are reported in, thresholds of the recognizers are scaled by it
+    static void GetSize(unsigned int &width, unsigned int &height);
+
+    // override the size, 0 x 0 restores the default (engine viewport, or 1280 x 720 for headless builds)
+    static void SetSize(unsigned int width, unsigned int height);
+};
+
+//---------------------------- clock shim ----------------------------
+// same interface as HexTimeCounter, additionally the clock can be driven manually (replay, batch recognition)
+// the game thread starts, stops and drives it while the input thread stamps samples with it, so its state is atomic:
+// a reader sees the start tick or manual time published with the flag that enables it
+class GestureClock
+{
+public:
+    GestureClock();
+
+    void StartTimer();
+    void StopTimer();
+    inline bool IsTimerStopped() const { return mStopped.load(std::memory_order_acquire); }
+
+    // milliseconds since StartTimer
+    HexTime GetTimeSlapped() const;
+
+    // switch to manual mode, GetTimeSlapped returns the given time until the next call
+    void SetManualTime(HexTime time);
+    inline bool IsManual() const { return mManual.load(std::memory_order_acquire); }
+private:
+    GestureClock(const GestureClock &);
+    GestureClock &operator = (const GestureClock &);
+
+#ifndef GESTURE_HEADLESS
+    HexTimeCounter mCounter;
+#else
+    std::atomic<unsigned long long> mStartTick;
+#endif
+    std::atomic<HexTime> mManualTime;
+    std::atomic<bool> mManual;
+    std::atomic<bool> mStopped;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef GESTURE_POLICY_H_
+#define GESTURE_POLICY_H_
+
+#include "input/GesturePlatform.h"
+
+//---------------------------- compile time parameters of the gesture core ----------------------------
+// BaseGestureRecognizer takes its default thresholds from DefaultGesturePolicy,
+// StaticGestureRecognizer<Policy> / StaticTouchManager<Policy> fold every value in as a constant
+// a custom policy derives from DefaultGesturePolicy and hides the values it changes
+// note: use the values by value only (no const reference), they have no out of line definition
+struct DefaultGesturePolicy
+{
+    static constexpr HexTime MAX_INTERVAL_OF_DOUBLE_CLICK           = 300;
+    static constexpr HexTime MIN_STEADY_TIME_FOR_DRAG               = 200;
+    static constexpr HexTime MIN_TIME_FOR_LONG_TAP                  = 500;
+    static constexpr HexTime MAX_TIME_FOR_SWIPE                     = 700;
+    static constexpr float MIN_X_RATIO_FOR_ARC                      = 0.5f;
+    static constexpr float MIN_Y_CHANGE_PERSENT_FOR_ARC             = 0.25f;
+    static constexpr float MAX_DISTANCE_RATIO_FOR_STEADY            = 0.005f;
+    static constexpr float MAX_ANGLE_COS_VALUE_FOR_ROTATE           = 0.98f;
+    static constexpr float MAX_SWIPE_DURATION_FOR_WHOLE_SCREEN      = 0.5f;
+    // ms ahead the move and drag-move events predict the contact, 0 for no prediction
+    static constexpr HexTime PREDICTION_HORIZON                     = 0;
+
+    // the static variants only, BaseGestureRecognizer and TouchManager take these at runtime
+    static constexpr unsigned int VIEWPORT_WIDTH                    = 1280;
+    static constexpr unsigned int VIEWPORT_HEIGHT                   = 720;
+    static constexpr unsigned int MAX_CONTACTS                      = 10;
+    // stored points per track (at least 16), longer tracks are simplified online, see TouchQueue::SetTrackMemoryBudget
+    static constexpr unsigned int MAX_TRACK_POINTS                  = 256;
+    static constexpr unsigned int RECENT_TRACK_POINTS               = 32;
+};
+
+#endif
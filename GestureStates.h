@@ -0,0 +1,424 @@
+#ifndef GESTURE_STATES_H_
+#define GESTURE_STATES_H_
+
+#include "input/BaseGestureRecognizer.h"
+#include "input/GestureEvents.h"
+#include "input/GestureFixedPoint.h"
+
+//---------------------------- the gesture state machine ----------------------------
+// the one implementation of the per-frame recognition, instantiated by
+//   BaseGestureRecognizer: runtime thresholds, the state handlers are virtual
+//   StaticGestureRecognizer<Policy>: constexpr thresholds and final handlers, the whole frame inlines and folds
+// the touch queues are shared by every recognizer of a TouchManager, so the state machine only reads them,
+// through the per-change feature block of the queue (TouchQueue::GetTrackFeatures)
+// Machine provides the threshold getters (GetMaxIntervalOfDoubleClick() ...), TouchQueueType and
+// GetTouchQueue(info), and the handlers OnTapState ... OnMultiTouch, Update dispatches to them
+template <class Machine>
+struct GestureStates
+{
+    typedef typename Machine::TouchQueueInfomation Infomation;
+    typedef typename Machine::TouchQueueType Queue;
+
+    static unsigned int GetActiveTouchQueueCount(Machine &m)
+    {
+        unsigned int val = 0;
+        for (unsigned int slot = m.mFirstChanged; slot != Machine::NO_CHANGED_SLOT; slot = m.mTouchQueueInfomations[slot].nextChanged)
+        {
+            if (m.GetTouchQueue(m.mTouchQueueInfomations[slot]).IsActived())
+            {
+                val++;
+            }
+        }
+        return val;
+    }
+
+#ifdef GESTURE_STATS
+    static inline unsigned int StatsHandler(typename Machine::TouchState state)
+    {
+        switch (state)
+        {
+            case Machine::STATE_TAP:        return GestureRecognizerStats::HANDLER_TAP;
+            case Machine::STATE_SWIPE:      return GestureRecognizerStats::HANDLER_SWIPE;
+            case Machine::STATE_MOVE:       return GestureRecognizerStats::HANDLER_MOVE;
+            case Machine::STATE_LONG_TAP:   return GestureRecognizerStats::HANDLER_LONG_TAP;
+            case Machine::STATE_DOUBLE_TAP: return GestureRecognizerStats::HANDLER_DOUBLE_TAP;
+            case Machine::STATE_DRAG:       return GestureRecognizerStats::HANDLER_DRAG;
+            case Machine::STATE_DRAG_MOVE:  return GestureRecognizerStats::HANDLER_DRAG_MOVE;
+            default:                        return GestureRecognizerStats::HANDLER_COUNT;
+        }
+    }
+#endif
+
+    static void Update(Machine &m, HexTime currentTime)
+    {
+#ifdef GESTURE_STATS
+        m.mStats.changedQueueDepth = m.mChangedCount;
+        if (m.mChangedCount > m.mStats.maxChangedQueueDepth)
+            m.mStats.maxChangedQueueDepth = m.mChangedCount;
+#endif
+        if (GetActiveTouchQueueCount(m) > 1)
+        {
+            GESTURE_STATS_ONLY(GestureStatsTimer timer(m.mStats.handlerNanoseconds[GestureRecognizerStats::HANDLER_MULTI_TOUCH],
+                    m.mStats.handlerCalls[GestureRecognizerStats::HANDLER_MULTI_TOUCH]));
+            m.OnMultiTouch(currentTime);
+        }
+        else
+        {
+            if (m.mInMultiTouchMove)
+            {
+                new (m.NewGestureEvent()) GestureEndMoveEvent(m.mLastMultiTouchMoveX, m.mLastMultiTouchMoveY, currentTime, 2);
+                m.mLastMultiTouchMoveX = m.mLastMultiTouchMoveY = 0;
+                m.mInMultiTouchMove = false;
+            }
+            //every handler drops the queue unless it keeps it for the next Update
+            unsigned int slot = m.mFirstChanged;
+            while (slot != Machine::NO_CHANGED_SLOT)
+            {
+                Infomation &info = m.mTouchQueueInfomations[slot];
+                unsigned int nextSlot = info.nextChanged;
+                typename Machine::TouchState state = info.curState;
+                info.keep = false;
+#ifdef GESTURE_STATS
+                //the states without a handler are not timed
+                unsigned int handler = StatsHandler(info.curState);
+                unsigned long long ignored = 0;
+                GestureStatsTimer timer((handler < GestureRecognizerStats::HANDLER_COUNT) ? m.mStats.handlerNanoseconds[handler] : ignored,
+                        (handler < GestureRecognizerStats::HANDLER_COUNT) ? m.mStats.handlerCalls[handler] : ignored);
+#endif
+                switch (info.curState)
+                {
+                    case Machine::STATE_TAP:
+                        m.OnTapState(info, currentTime);
+                        break;
+                    case Machine::STATE_SWIPE:
+                        m.OnSwipeState(info, currentTime);
+                        break;
+                    case Machine::STATE_MOVE:
+                        m.OnMoveState(info, currentTime);
+                        break;
+                    case Machine::STATE_LONG_TAP:
+                        m.OnLongTapState(info, currentTime);
+                        break;
+                    case Machine::STATE_DOUBLE_TAP:
+                        m.OnDoubleTapState(info, currentTime);
+                        break;
+                    case Machine::STATE_DRAG:
+                        m.OnDragState(info, currentTime);
+                        break;
+                    case Machine::STATE_DRAG_MOVE:
+                        m.OnDragMoveState(info, currentTime);
+                        break;
+                    //the queue is force released for this recognizer: its state is dropped below
+                    case Machine::STATE_MULTI:
+                        break;
+                    case Machine::STATE_NONE:
+                        break;
+                    default:
+                        break;
+                }
+                if (!info.keep)
+                {
+                    m.TraceTransition(slot, state, Machine::STATE_NONE, currentTime);
+                    m.UnlinkChanged(slot);
+                }
+                else
+                {
+                    m.TraceTransition(slot, state, info.curState, currentTime);
+                }
+                slot = nextSlot;
+            }
+        }
+    }
+
+    static void OnTapState(Machine &m, Infomation &info, HexTime time)
+    {
+        Queue &queue = m.GetTouchQueue(info);
+        const TouchQueue::TrackFeatures &features = queue.GetTrackFeatures();
+        if (!queue.IsActived())
+        {
+            // touch release
+            if (info.repeatTimes <= 1)
+            {
+                if (info.releaseTime + m.GetMaxIntervalOfDoubleClick() < time)
+                {
+                    // tap event
+                    new (m.NewGestureEvent()) GestureTapEvent(features.startX, features.startY, time, 1);
+                }
+                else
+                {
+                    m.KeepTouchQueueInfomation(info);
+                }
+                return;
+            }
+            else
+            {
+                // double click
+                info.curState = Machine::STATE_DOUBLE_TAP;
+                m.KeepTouchQueueInfomation(info);
+                return;
+            }
+        }
+        else
+        {
+            if ((features.maxDistanceX > m.GetMaxSteadyMoveDistanceX()) || (features.maxDistanceY > m.GetMaxSteadyMoveDistanceY()))
+            {
+                // point moved, change to swipe or move state
+#ifdef GESTURE_FIXED_POINT
+                if (features.hasSpeeds && (features.maxSpeedSquared < m.GetMinSpeedSquaredForSwipe()))
+#else
+                if (features.hasSpeeds && (features.maxSpeed < m.GetMinSpeedForSwipe()))
+#endif
+                {
+                    info.curState = Machine::STATE_MOVE;
+                }
+                else
+                {
+                    info.curState = Machine::STATE_SWIPE;
+                }
+                m.KeepTouchQueueInfomation(info);
+                return;
+            }
+            if (features.GetCurrentDuration(time) > m.GetMinSteadyTimeForDrag())
+            {
+                info.curState = Machine::STATE_DRAG;
+                m.KeepTouchQueueInfomation(info);
+                return;
+            }
+            m.KeepTouchQueueInfomation(info);
+        }
+    }
+
+    static void OnSwipeState(Machine &m, Infomation &info, HexTime time)
+    {
+        Queue &queue = m.GetTouchQueue(info);
+        const TouchQueue::TrackFeatures &features = queue.GetTrackFeatures();
+        if (!queue.IsActived() || (features.GetCurrentDuration(time) >= m.GetMaxSwipeDuration()))
+        {
+            TouchQueue::ArcShape arcType;
+            TouchQueue::Direction direction;
+            bool isArc = queue.IsArcTrack(m.GetMinXDistanceForArc(), m.GetMinYChangePersentForArc(), arcType, direction);
+            if (isArc)
+                new (m.NewGestureEvent()) GestureArcEvent(features.startX, features.startY, time, 1, arcType, direction);
+            else
+                new (m.NewGestureEvent()) GestureSwipeEvent(features.startX, features.startY, time, 1, direction);
+
+            //force release the touch queue when it expired: not kept, the rest of the touch is ignored
+        }
+        else
+        {
+            m.KeepTouchQueueInfomation(info);
+        }
+    }
+
+    static void OnLongTapState(Machine &m, Infomation &info, HexTime time)
+    {
+        Queue &queue = m.GetTouchQueue(info);
+        const TouchQueue::TrackFeatures &features = queue.GetTrackFeatures();
+        if (!queue.IsActived())
+        {
+            new (m.NewGestureEvent()) GestureLongTapEvent(features.startX, features.startY, time, 1, features.duration);
+        }
+        else
+        {
+            m.KeepTouchQueueInfomation(info);
+        }
+    }
+
+    static void OnDoubleTapState(Machine &m, Infomation &info, HexTime time)
+    {
+        Queue &queue = m.GetTouchQueue(info);
+        const TouchQueue::TrackFeatures &features = queue.GetTrackFeatures();
+        if (!queue.IsActived())
+        {
+            new (m.NewGestureEvent()) GestureDoubleClickEvent(features.startX, features.startY, time, 1);
+        }
+        else
+        {
+            if ((features.maxDistanceX > m.GetMaxSteadyMoveDistanceX()) || (features.maxDistanceY > m.GetMaxSteadyMoveDistanceY()))
+            {
+                // point moved, change to swipe state
+                info.curState = Machine::STATE_SWIPE;
+                m.KeepTouchQueueInfomation(info);
+                return;
+            }
+            if (features.GetCurrentDuration(time) > m.GetMinSteadyTimeForDrag())
+            {
+                info.curState = Machine::STATE_DRAG;
+                m.KeepTouchQueueInfomation(info);
+                return;
+            }
+            m.KeepTouchQueueInfomation(info);
+        }
+    }
+
+    static void OnMoveState(Machine &m, Infomation &info, HexTime time)
+    {
+        Queue &queue = m.GetTouchQueue(info);
+        const TouchQueue::TrackFeatures &features = queue.GetTrackFeatures();
+        if (!queue.IsActived())
+        {
+            new (m.NewGestureEvent()) GestureEndMoveEvent(features.endX, features.endY, time, 1);
+        }
+        else
+        {
+            int predictedX, predictedY;
+            if (m.GetPredictionHorizon() && queue.PredictPosition(time, m.GetPredictionHorizon(), predictedX, predictedY))
+                new (m.NewGestureEvent()) GestureMoveEvent(features.endX, features.endY, time, 1, predictedX, predictedY, m.GetPredictionHorizon());
+            else
+                new (m.NewGestureEvent()) GestureMoveEvent(features.endX, features.endY, time, 1);
+            m.KeepTouchQueueInfomation(info);
+        }
+    }
+
+    static void OnDragState(Machine &m, Infomation &info, HexTime time)
+    {
+        Queue &queue = m.GetTouchQueue(info);
+        const TouchQueue::TrackFeatures &features = queue.GetTrackFeatures();
+        if (!queue.IsActived())
+        {
+            //release touch in drag state, triggered tap or long-tap event
+            if (features.GetCurrentDuration(time) >= m.GetMinTimeForLongTap())
+                new (m.NewGestureEvent()) GestureLongTapEvent(features.startX, features.startY, time, 1, features.duration);
+            else
+                new (m.NewGestureEvent()) GestureTapEvent(features.startX, features.startY, time, 1);
+        }
+        else
+        {
+            if ((features.maxDistanceX > m.GetMaxSteadyMoveDistanceX()) || (features.maxDistanceY > m.GetMaxSteadyMoveDistanceY()))
+            {
+                // point moved, trigger drag event and change to drag-move state
+                new (m.NewGestureEvent()) GestureDragEvent(features.startX, features.startY, time, 1);
+                info.curState = Machine::STATE_DRAG_MOVE;
+                m.KeepTouchQueueInfomation(info);
+                return;
+            }
+            m.KeepTouchQueueInfomation(info);
+        }
+    }
+
+    static void OnDragMoveState(Machine &m, Infomation &info, HexTime time)
+    {
+        Queue &queue = m.GetTouchQueue(info);
+        const TouchQueue::TrackFeatures &features = queue.GetTrackFeatures();
+        if (!queue.IsActived())
+        {
+            new (m.NewGestureEvent()) GestureDropEvent(features.endX, features.endY, time, 1);
+        }
+        else
+        {
+            int predictedX, predictedY;
+            if (m.GetPredictionHorizon() && queue.PredictPosition(time, m.GetPredictionHorizon(), predictedX, predictedY))
+                new (m.NewGestureEvent()) GestureDragMoveEvent(features.endX, features.endY, time, 1, predictedX, predictedY, m.GetPredictionHorizon());
+            else
+                new (m.NewGestureEvent()) GestureDragMoveEvent(features.endX, features.endY, time, 1);
+            m.KeepTouchQueueInfomation(info);
+        }
+    }
+
+    static void OnMultiTouch(Machine &m, HexTime time)
+    {
+        //only the first two active queues are needed
+        Queue *temp[2];
+        int count = 0;
+        for (unsigned int slot = m.mFirstChanged; slot != Machine::NO_CHANGED_SLOT; slot = m.mTouchQueueInfomations[slot].nextChanged)
+        {
+            Infomation &info = m.mTouchQueueInfomations[slot];
+            Queue &queue = m.GetTouchQueue(info);
+            if (queue.IsActived())
+            {
+                if (count < 2)
+                    temp[count] = &queue;
+                count ++;
+                m.TraceTransition(slot, info.curState, Machine::STATE_MULTI, time);
+                info.curState = Machine::STATE_MULTI;
+            }
+        }
+        if (count == 2) // rotate pinch
+        {
+            const TouchQueue::TrackFeatures &f0 = temp[0]->GetTrackFeatures();
+            const TouchQueue::TrackFeatures &f1 = temp[1]->GetTrackFeatures();
+#ifdef GESTURE_FIXED_POINT
+            //the float branch below on integers, p0 / p1 start and end of the first track, p2 / p3 of the second
+            long long v0x = (long long)f0.endX - f0.startX;
+            long long v0y = (long long)f0.endY - f0.startY;
+            long long v1x = (long long)f1.endX - f1.startX;
+            long long v1y = (long long)f1.endY - f1.startY;
+            unsigned long long steady = m.GetMaxDistanceSquaredForSteady();
+            bool steady0 = (unsigned long long)(v0x * v0x + v0y * v0y) < steady;
+            bool steady1 = (unsigned long long)(v1x * v1x + v1y * v1y) < steady;
+            if (steady0 && steady1)
+                return;
+            if (steady0 || steady1)
+            {
+                new (m.NewGestureEvent()) GestureRotateEvent(f0.endX, f0.endY, time, 2, 1.0f);
+            }
+            else if (v0x * v1x + v0y * v1y > 0)
+            {
+                //the midpoint truncated toward zero, as the float version converts it
+                int x = (int)(((long long)f0.endX + f1.endX) / 2);
+                int y = (int)(((long long)f0.endY + f1.endY) / 2);
+                new (m.NewGestureEvent()) GestureMoveEvent(x, y, time, 2);
+                m.mInMultiTouchMove = true;
+                m.mLastMultiTouchMoveX = x;
+                m.mLastMultiTouchMoveY = y;
+            }
+            else
+            {
+                //squared distance ratio of the ends to the starts in Q16, a float of it is the same everywhere
+                long long ex = (long long)f0.endX - f1.endX;
+                long long ey = (long long)f0.endY - f1.endY;
+                long long sx = (long long)f0.startX - f1.startX;
+                long long sy = (long long)f0.startY - f1.startY;
+                unsigned long long endSquared = ex * ex + ey * ey;
+                unsigned long long startSquared = sx * sx + sy * sy;
+                float scale;
+                if (startSquared)
+                    scale = (float)((endSquared << FixedPoint::Q16_SHIFT) / startSquared) / (float)FixedPoint::Q16_ONE;
+                else
+                    scale = endSquared ? (float)endSquared : 1.0f;
+                new (m.NewGestureEvent()) GesturePinchEvent(f1.endX, f1.endY, time, 2, scale);
+            }
+#else
+            FastMath::Vector3 p0 = FastMath::Vector3(f0.startX, f0.startY, 0.0f);
+            FastMath::Vector3 p1 = FastMath::Vector3(f0.endX, f0.endY, 0.0f);
+            FastMath::Vector3 v0 = FastMath::Vector3(f0.endX - f0.startX, f0.endY - f0.startY, 0.0f);
+            FastMath::Vector3 p2 = FastMath::Vector3(f1.startX, f1.startY, 0.0f);
+            FastMath::Vector3 p3 = FastMath::Vector3(f1.endX, f1.endY, 0.0f);
+            FastMath::Vector3 v1 = FastMath::Vector3(f1.endX - f1.startX, f1.endY - f1.startY, 0.0f);
+            float len1 = v0.Length();
+            float len2 = v1.Length();
+            float steady = m.GetMaxDistanceRatioForSteady();
+            if ((len1 < steady) && (len2 < steady))
+            {
+                //hold stady, exit anyway
+                return;
+            }
+            if ((len1 < steady) || (len2 < steady))
+            {
+                //roc todo, buggy here
+                new (m.NewGestureEvent()) GestureRotateEvent(p1.x(), p1.y(), time, 2, 1.0f);
+            }
+            else
+            {
+                float dot = v0.DotProduct(v1);
+                if (dot > 0.0f)
+                {
+                    //two tracks in the same direction, move
+                    p0 = (p1 + p3) * 0.5f;
+                    new (m.NewGestureEvent()) GestureMoveEvent(p0.x(), p0.y(), time, 2);
+                    m.mInMultiTouchMove = true;
+                    m.mLastMultiTouchMoveX = p0.x();
+                    m.mLastMultiTouchMoveY = p0.y();
+                }
+                else
+                {
+                    //pinch
+                    new (m.NewGestureEvent()) GesturePinchEvent(p3.x(), p3.y(), time, 2, p1.DistanceSquared(p3) / p0.DistanceSquared(p2));
+                }
+            }
+#endif
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "input/GestureStats.h"
+#include <chrono>
+
+//--------------------------------------------- GestureRecognizerStats ---------------------------------------------
+void GestureRecognizerStats::Reset()
+{
+    for (unsigned int i=0; i<HANDLER_COUNT; i++)
+        handlerCalls[i] = handlerNanoseconds[i] = 0;
+    changedQueueDepth = maxChangedQueueDepth = 0;
+}
+
+//---------------------------------------------- GestureStatsSnapshot ----------------------------------------------
+void GestureStatsSnapshot::Reset()
+{
+#ifdef GESTURE_STATS
+    enabled = true;
+#else
+    enabled = false;
+#endif
+    updateCount = updateNanoseconds = maxUpdateNanoseconds = 0;
+    for (unsigned int i=0; i<GestureRecognizerStats::HANDLER_COUNT; i++)
+        handlerCalls[i] = handlerNanoseconds[i] = 0;
+    changedQueueDepth = maxChangedQueueDepth = 0;
+    eventsDispatched = 0;
+    eventsDropped = samplesDropped = 0;
+    activeTracks = trackPoints = maxTrackPoints = trackBytes = 0;
+    arenaBytes = arenaUsedBytes = arenaOverflows = 0;
+}
+
+//----------------------------------------------- GestureStatsTimer -----------------------------------------------
+unsigned long long GestureStatsTimer::Now()
+{
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,94 @@
+#ifndef GESTURE_STATS_H_
+#define GESTURE_STATS_H_
+
+#include "input/GesturePlatform.h"
+
+// note: the counters are built with GESTURE_STATS only (cmake -DGESTURE_ENABLE_STATS=ON), otherwise every
+// GESTURE_STATS_ONLY statement compiles out and the snapshot carries the track gauges alone
+#ifdef GESTURE_STATS
+#define GESTURE_STATS_ONLY(statement)   statement
+#else
+#define GESTURE_STATS_ONLY(statement)
+#endif
+
+//---------------------------- counters of the recognition hot path ----------------------------
+// the per recognizer part, written by the state machine (GestureStates.h)
+struct GestureRecognizerStats
+{
+    // the state handlers, OnTapState ... OnMultiTouch
+    enum Handler
+    {
+        HANDLER_TAP             = 0,
+        HANDLER_MOVE            = 1,
+        HANDLER_SWIPE           = 2,
+        HANDLER_LONG_TAP        = 3,
+        HANDLER_DOUBLE_TAP      = 4,
+        HANDLER_DRAG            = 5,
+        HANDLER_DRAG_MOVE       = 6,
+        HANDLER_MULTI_TOUCH     = 7,
+        HANDLER_COUNT           = 8,
+    };
+
+    GestureRecognizerStats() { Reset(); }
+    void Reset();
+
+    unsigned long long handlerCalls[HANDLER_COUNT];
+    unsigned long long handlerNanoseconds[HANDLER_COUNT];
+    // changed touch queues at the start of an Update
+    unsigned int changedQueueDepth;
+    unsigned int maxChangedQueueDepth;
+};
+
+// what TouchManager::GetStatsSnapshot reports, the counters since the last ResetStats
+struct GestureStatsSnapshot
+{
+    GestureStatsSnapshot() { Reset(); }
+    void Reset();
+
+    // false when built without GESTURE_STATS, only the gauges below the counters are filled then
+    bool enabled;
+
+    // TouchManager::Update
+    unsigned long long updateCount;
+    unsigned long long updateNanoseconds;
+    unsigned long long maxUpdateNanoseconds;
+    // summed over every recognizer
+    unsigned long long handlerCalls[GestureRecognizerStats::HANDLER_COUNT];
+    unsigned long long handlerNanoseconds[GestureRecognizerStats::HANDLER_COUNT];
+    unsigned int changedQueueDepth;
+    unsigned int maxChangedQueueDepth;
+    unsigned long long eventsDispatched;
+
+    // gauges, read when the snapshot is taken
+    unsigned int eventsDropped;         // recognizer queues and the input time ring
+    unsigned int samplesDropped;        // the input ring
+    unsigned int activeTracks;
+    unsigned int trackPoints;           // stored, over every track
+    unsigned int maxTrackPoints;
+    unsigned int trackBytes;            // held by the track storages
+    unsigned int arenaBytes;            // the track arena of the manager, see TouchTrackArena
+    unsigned int arenaUsedBytes;
+    unsigned int arenaOverflows;        // track runs the arena could not serve
+};
+
+//---------------------------- scope timer of a handler ----------------------------
+class GestureStatsTimer
+{
+public:
+    // monotonic clock in nanoseconds
+    static unsigned long long Now();
+
+    GestureStatsTimer(unsigned long long &nanoseconds, unsigned long long &calls) : mNanoseconds(nanoseconds), mStart(Now())
+    {
+        calls ++;
+    }
+    ~GestureStatsTimer() { mNanoseconds += Now() - mStart; }
+private:
+    GestureStatsTimer(const GestureStatsTimer &);
+    GestureStatsTimer &operator = (const GestureStatsTimer &);
+
+    unsigned long long &mNanoseconds;
+    unsigned long long mStart;
+};
+
+#endif
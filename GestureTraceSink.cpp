@@ -0,0 +1,159 @@
+#include "input/GestureTraceSink.h"
+#include "input/GestureMemory.h"
+#include "input/GestureEvents.h"
+#include "input/GestureStats.h"
+
+// names of BaseGestureRecognizer::TouchState
+static const char *_STATE_NAMES_[] =
+{
+    "tap", "begin move", "move", "end move", "swipe", "long tap", "double tap", "drag", "drag move", "multi", "none",
+};
+// names of the GESTURE_ event types
+static const char *_EVENT_NAMES_[] =
+{
+    "unknown", "begin move", "move", "end move", "tap", "long tap", "double click", "swipe", "arc", "drag", "drag move",
+    "drop", "pinch", "rotate", "shape",
+};
+
+static inline const char *_StateName(unsigned int state)
+{
+    return state < sizeof(_STATE_NAMES_) / sizeof(_STATE_NAMES_[0]) ? _STATE_NAMES_[state] : "?";
+}
+
+static inline const char *_EventName(unsigned int type)
+{
+    return type < sizeof(_EVENT_NAMES_) / sizeof(_EVENT_NAMES_[0]) ? _EVENT_NAMES_[type] : "?";
+}
+
+//------------------------------------------------ GestureTraceSink ------------------------------------------------
+GestureTraceSink::GestureTraceSink(unsigned int capacity) : mCapacity(capacity), mHead(0), mCount(0), mOverwrittenCount(0)
+{
+    assert(mCapacity >= 1);
+    mRecords = (GestureTraceRecord *)GestureMemory::Allocate(sizeof(GestureTraceRecord) * mCapacity);
+    assert(mRecords);
+}
+
+GestureTraceSink::~GestureTraceSink()
+{
+    GestureMemory::Free(mRecords);
+}
+
+void GestureTraceSink::Clear()
+{
+    mHead = mCount = mOverwrittenCount = 0;
+}
+
+GestureTraceRecord &GestureTraceSink::NextRecord()
+{
+    unsigned int slot = mHead + mCount;
+    if (slot >= mCapacity)
+        slot -= mCapacity;
+    if (mCount == mCapacity)
+    {
+        //full, the oldest goes
+        mHead = (mHead + 1 == mCapacity) ? 0 : mHead + 1;
+        mOverwrittenCount ++;
+    }
+    else
+    {
+        mCount ++;
+    }
+    GestureTraceRecord &record = mRecords[slot];
+    memset(&record, 0, sizeof(record));
+    return record;
+}
+
+const GestureTraceRecord &GestureTraceSink::GetRecord(unsigned int index) const
+{
+    assert(index < mCount);
+    unsigned int slot = mHead + index;
+    return mRecords[slot >= mCapacity ? slot - mCapacity : slot];
+}
+
+void GestureTraceSink::RecordUpdate(unsigned long long start, unsigned long long end, HexTime time)
+{
+    GestureTraceRecord &record = NextRecord();
+    record.kind = GestureTraceRecord::KIND_UPDATE;
+    record.timestamp = start;
+    record.duration = (unsigned int)(end - start);
+    record.time = time;
+}
+
+void GestureTraceSink::RecordTransition(unsigned int recognizer, unsigned int touchIndex, unsigned int from, unsigned int to, HexTime time)
+{
+    GestureTraceRecord &record = NextRecord();
+    record.kind = GestureTraceRecord::KIND_TRANSITION;
+    record.timestamp = GestureStatsTimer::Now();
+    record.time = time;
+    record.touchIndex = (__u16)touchIndex;
+    record.recognizer = (__u8)recognizer;
+    record.from = (__u8)from;
+    record.to = (__u8)to;
+}
+
+void GestureTraceSink::RecordEvent(unsigned int recognizer, const BaseGestureEvent &event)
+{
+    GestureTraceRecord &record = NextRecord();
+    record.kind = GestureTraceRecord::KIND_EVENT;
+    record.timestamp = GestureStatsTimer::Now();
+    record.time = event.GetEventTime();
+    record.x = event.GetEventX();
+    record.y = event.GetEventY();
+    record.touchIndex = (__u16)event.GetTouchCount();
+    record.recognizer = (__u8)recognizer;
+    record.from = event.GetEventType();
+}
+
+bool GestureTraceSink::ExportChromeTrace(const char *path) const
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+    bool result = ExportChromeTrace(file);
+    return (fclose(file) == 0) && result;
+}
+
+bool GestureTraceSink::ExportChromeTrace(FILE *file) const
+{
+    //pid 1, tid 0 the recognition passes and events, tid slot + 1 the states of a touch slot
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gestures\"}},\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"recognition\"}}");
+    //a name for every slot seen
+    unsigned int namedSlots = 0;
+    for (unsigned int i=0; i<mCount; i++)
+    {
+        const GestureTraceRecord &record = GetRecord(i);
+        if ((record.kind == GestureTraceRecord::KIND_TRANSITION) && (record.touchIndex + 1u > namedSlots))
+            namedSlots = record.touchIndex + 1u;
+    }
+    for (unsigned int slot=0; slot<namedSlots; slot++)
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"touch %u\"}}", slot + 1, slot);
+
+    for (unsigned int i=0; i<mCount; i++)
+    {
+        const GestureTraceRecord &record = GetRecord(i);
+        double ts = (double)record.timestamp / 1000.0;
+        switch (record.kind)
+        {
+            case GestureTraceRecord::KIND_UPDATE:
+                fprintf(file, ",\n{\"name\":\"Update\",\"cat\":\"gesture\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":0,"
+                        "\"args\":{\"time\":%u}}", ts, (double)record.duration / 1000.0, (unsigned int)record.time);
+                break;
+            case GestureTraceRecord::KIND_TRANSITION:
+                fprintf(file, ",\n{\"name\":\"%s -> %s\",\"cat\":\"state\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                        "\"args\":{\"touch\":%u,\"recognizer\":%u,\"time\":%u}}", _StateName(record.from), _StateName(record.to), ts,
+                        record.touchIndex + 1u, (unsigned int)record.touchIndex, (unsigned int)record.recognizer, (unsigned int)record.time);
+                break;
+            case GestureTraceRecord::KIND_EVENT:
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"event\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":0,"
+                        "\"args\":{\"x\":%d,\"y\":%d,\"touches\":%u,\"recognizer\":%u,\"time\":%u}}", _EventName(record.from), ts,
+                        record.x, record.y, (unsigned int)record.touchIndex, (unsigned int)record.recognizer, (unsigned int)record.time);
+                break;
+            default:
+                break;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return !ferror(file);
+}
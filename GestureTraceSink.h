@@ -0,0 +1,72 @@
+#ifndef GESTURE_TRACE_SINK_H_
+#define GESTURE_TRACE_SINK_H_
+
+#include "input/GesturePlatform.h"
+#include <stdio.h>
+
+class BaseGestureEvent;
+
+// one entry of the sink
+struct GestureTraceRecord
+{
+    enum Kind
+    {
+        KIND_NONE           = 0,
+        KIND_UPDATE         = 1,    // a recognition pass, TouchManager::Update or a step at input time
+        KIND_TRANSITION     = 2,    // a touch queue changed its state in a recognizer
+        KIND_EVENT          = 3,    // a gesture event was recognized
+    };
+
+    unsigned long long timestamp;   // monotonic clock in ns, see GestureStatsTimer::Now
+    unsigned int duration;          // ns, updates only
+    HexTime time;                   // gesture clock of the pass
+    int x;                          // events only
+    int y;
+    __u16 touchIndex;               // track slot of a transition, touch count of an event
+    __u8 kind;
+    __u8 recognizer;                // attach order in the TouchManager
+    __u8 from;                      // TouchState before a transition, the type of an event
+    __u8 to;                        // TouchState after a transition
+};
+
+//---------------------------- sink of the recognizer timeline ----------------------------
+// records every recognition pass, every state transition of a touch queue and every event recognized into a
+// ring preallocated at construction, the oldest records are overwritten once it is full
+// ExportChromeTrace writes the ring as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev):
+// the passes as complete spans and the events on a "recognition" track, the transitions on one track per touch slot
+// attach it with TouchManager::SetTraceSink, it is written by the thread that recognizes only
+class GestureTraceSink
+{
+public:
+    GestureTraceSink(unsigned int capacity = 65536);
+    ~GestureTraceSink();
+
+    void RecordUpdate(unsigned long long start, unsigned long long end, HexTime time);
+    void RecordTransition(unsigned int recognizer, unsigned int touchIndex, unsigned int from, unsigned int to, HexTime time);
+    void RecordEvent(unsigned int recognizer, const BaseGestureEvent &event);
+
+    void Clear();
+    inline unsigned int GetCapacity() const { return mCapacity; }
+    inline unsigned int GetRecordCount() const { return mCount; }
+    // records lost to the ring, the oldest first
+    inline unsigned int GetOverwrittenCount() const { return mOverwrittenCount; }
+    // index 0 is the oldest record kept
+    const GestureTraceRecord &GetRecord(unsigned int index) const;
+
+    // returns false if the file can not be written
+    bool ExportChromeTrace(const char *path) const;
+    bool ExportChromeTrace(FILE *file) const;
+private:
+    GestureTraceSink(const GestureTraceSink &);
+    GestureTraceSink &operator = (const GestureTraceSink &);
+
+    GestureTraceRecord &NextRecord();
+
+    GestureTraceRecord *mRecords;
+    unsigned int mCapacity;
+    unsigned int mHead;
+    unsigned int mCount;
+    unsigned int mOverwrittenCount;
+};
+
+#endif
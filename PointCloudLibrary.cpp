@@ -0,0 +1,260 @@
+#include "input/PointCloudLibrary.h"
+#include "input/TouchTrackKernels.h"
+#include <algorithm>
+
+// starts of the greedy matching: every floor(POINT_CLOUD_SIZE ^ 0.5)-th point, as $P does
+static const unsigned int _GREEDY_MATCH_STEP_       = 5;
+static const unsigned int _COARSE_GRID_SIZE_        = 4;
+static const unsigned int _DEFAULT_CANDIDATE_COUNT_ = 64;
+// takes a matched point out of NearestPoint
+static const float _MATCHED_PENALTY_                = 1e30f;
+
+//--------------------------------------------- PointCloudLibrary ---------------------------------------------
+PointCloudLibrary::PointCloudLibrary() : mCandidateCount(_DEFAULT_CANDIDATE_COUNT_)
+{
+}
+
+PointCloudLibrary::~PointCloudLibrary()
+{
+}
+
+bool PointCloudLibrary::Normalize(const float *x, const float *y, const unsigned int *strokes, unsigned int count, PointCloud &cloud)
+{
+    if (count < 2)
+        return false;
+    float length = 0.0f;
+    for (unsigned int i=1; i<count; i++)
+    {
+        if (strokes && (strokes[i] != strokes[i - 1]))
+            continue;
+        float dx = x[i] - x[i - 1];
+        float dy = y[i] - y[i - 1];
+        length += sqrtf(dx * dx + dy * dy);
+    }
+    if (length <= 0.0f)
+        return false;
+
+    //resample to equidistant points along the strokes, the gaps between the strokes do not count
+    float interval = length / (float)(POINT_CLOUD_SIZE - 1);
+    float walked = 0.0f;
+    unsigned int n = 0;
+    cloud.x[n] = x[0];
+    cloud.y[n] = y[0];
+    n ++;
+    float prevX = x[0];
+    float prevY = y[0];
+    for (unsigned int i=1; (i<count) && (n<POINT_CLOUD_SIZE); i++)
+    {
+        if (strokes && (strokes[i] != strokes[i - 1]))
+        {
+            prevX = x[i];
+            prevY = y[i];
+            continue;
+        }
+        float dx = x[i] - prevX;
+        float dy = y[i] - prevY;
+        float d = sqrtf(dx * dx + dy * dy);
+        while ((walked + d >= interval) && (n < POINT_CLOUD_SIZE))
+        {
+            float t = (interval - walked) / d;
+            prevX += t * dx;
+            prevY += t * dy;
+            cloud.x[n] = prevX;
+            cloud.y[n] = prevY;
+            n ++;
+            dx = x[i] - prevX;
+            dy = y[i] - prevY;
+            d = sqrtf(dx * dx + dy * dy);
+            walked = 0.0f;
+        }
+        walked += d;
+        prevX = x[i];
+        prevY = y[i];
+    }
+    //rounding may leave the last point out
+    for (; n<POINT_CLOUD_SIZE; n++)
+    {
+        cloud.x[n] = x[count - 1];
+        cloud.y[n] = y[count - 1];
+    }
+
+    //uniform scale into the unit box, then the centroid to the origin
+    float minX, minY, maxX, maxY;
+    TrackKernels::BoundingBox(cloud.x, cloud.y, POINT_CLOUD_SIZE, minX, minY, maxX, maxY);
+    float size = std::max(maxX - minX, maxY - minY);
+    if (size <= 0.0f)
+        return false;
+    float scale = 1.0f / size;
+    for (unsigned int i=0; i<POINT_CLOUD_SIZE; i++)
+    {
+        cloud.x[i] = (cloud.x[i] - minX) * scale;
+        cloud.y[i] = (cloud.y[i] - minY) * scale;
+    }
+    float centerX, centerY;
+    TrackKernels::Centroid(cloud.x, cloud.y, POINT_CLOUD_SIZE, centerX, centerY);
+    for (unsigned int i=0; i<POINT_CLOUD_SIZE; i++)
+    {
+        cloud.x[i] -= centerX;
+        cloud.y[i] -= centerY;
+    }
+    return true;
+}
+
+void PointCloudLibrary::ComputeSignature(const PointCloud &cloud, float *signature)
+{
+    //the normalized points lie within [-1, 1], the grid covers that square
+    for (unsigned int i=0; i<COARSE_CELLS; i++)
+        signature[i] = 0.0f;
+    float weight = 1.0f / (float)POINT_CLOUD_SIZE;
+    float cellScale = (float)_COARSE_GRID_SIZE_ * 0.5f;
+    for (unsigned int i=0; i<POINT_CLOUD_SIZE; i++)
+    {
+        int cx = (int)((cloud.x[i] + 1.0f) * cellScale);
+        int cy = (int)((cloud.y[i] + 1.0f) * cellScale);
+        cx = std::min(std::max(cx, 0), (int)_COARSE_GRID_SIZE_ - 1);
+        cy = std::min(std::max(cy, 0), (int)_COARSE_GRID_SIZE_ - 1);
+        signature[cy * _COARSE_GRID_SIZE_ + cx] += weight;
+    }
+}
+
+unsigned int PointCloudLibrary::AddTemplate(const char *name, const float *x, const float *y, const unsigned int *strokes, unsigned int count)
+{
+    PointCloud cloud;
+    if (!Normalize(x, y, strokes, count, cloud))
+        return NO_TEMPLATE;
+    return AddTemplate(name, cloud);
+}
+
+unsigned int PointCloudLibrary::AddTemplate(const char *name, const PointCloud &cloud)
+{
+    unsigned int index = mClouds.size();
+    mClouds.push_back(cloud);
+    mNames.push_back(name);
+    mSignatures.resize(mSignatures.size() + COARSE_CELLS);
+    ComputeSignature(cloud, &mSignatures[index * COARSE_CELLS]);
+    return index;
+}
+
+void PointCloudLibrary::Clear()
+{
+    mClouds.clear();
+    mNames.clear();
+    mSignatures.clear();
+}
+
+float PointCloudLibrary::CloudDistance(const PointCloud &a, const PointCloud &b, unsigned int start, float bound, const float *remaining)
+{
+    float penalty[POINT_CLOUD_SIZE];
+    for (unsigned int i=0; i<POINT_CLOUD_SIZE; i++)
+        penalty[i] = 0.0f;
+    float sum = 0.0f;
+    unsigned int i = start;
+    for (unsigned int k=0; k<POINT_CLOUD_SIZE; k++)
+    {
+        float distanceSquared;
+        unsigned int nearest = TrackKernels::NearestPoint(b.x, b.y, penalty, POINT_CLOUD_SIZE, a.x[i], a.y[i], distanceSquared);
+        penalty[nearest] = _MATCHED_PENALTY_;
+        //the first matches weigh most, they had the most points to choose from
+        float weight = 1.0f - (float)k / (float)POINT_CLOUD_SIZE;
+        sum += weight * sqrtf(distanceSquared);
+        //the points left can not match closer than their nearest neighbour
+        if (sum + remaining[k] >= bound)
+            return sum + remaining[k];
+        i = (i + 1) % POINT_CLOUD_SIZE;
+    }
+    return sum;
+}
+
+float PointCloudLibrary::LowerBound(const float *nearest, unsigned int start, float *remaining)
+{
+    //every point matched to its nearest neighbour, with the weights of CloudDistance
+    //remaining[k] gets the part of the points after the k-th one
+    float sum = 0.0f;
+    for (int k=POINT_CLOUD_SIZE - 1; k>=0; k--)
+    {
+        remaining[k] = sum;
+        sum += (1.0f - (float)k / (float)POINT_CLOUD_SIZE) * nearest[(start + k) % POINT_CLOUD_SIZE];
+    }
+    return sum;
+}
+
+float PointCloudLibrary::GreedyCloudMatch(const PointCloud &a, const PointCloud &b, float bound)
+{
+    //nearest neighbour distances of both clouds bound every start from below ($Q, Vatavu et al. 2018),
+    //the hopeless starts are skipped and the others stop as soon as they can not get below the bound
+    float nearestA[POINT_CLOUD_SIZE];
+    float nearestB[POINT_CLOUD_SIZE];
+    TrackKernels::NearestDistances(a.x, a.y, POINT_CLOUD_SIZE, b.x, b.y, POINT_CLOUD_SIZE, nearestA);
+    TrackKernels::NearestDistances(b.x, b.y, POINT_CLOUD_SIZE, a.x, a.y, POINT_CLOUD_SIZE, nearestB);
+    for (unsigned int i=0; i<POINT_CLOUD_SIZE; i++)
+    {
+        nearestA[i] = sqrtf(nearestA[i]);
+        nearestB[i] = sqrtf(nearestB[i]);
+    }
+    float remaining[POINT_CLOUD_SIZE];
+    float minDistance = bound;
+    for (unsigned int start=0; start<POINT_CLOUD_SIZE; start+=_GREEDY_MATCH_STEP_)
+    {
+        if (LowerBound(nearestA, start, remaining) < minDistance)
+        {
+            float d = CloudDistance(a, b, start, minDistance, remaining);
+            if (d < minDistance)
+                minDistance = d;
+        }
+        if (LowerBound(nearestB, start, remaining) < minDistance)
+        {
+            float d = CloudDistance(b, a, start, minDistance, remaining);
+            if (d < minDistance)
+                minDistance = d;
+        }
+    }
+    return minDistance;
+}
+
+struct _CoarseOrder
+{
+    const float *distances;
+    inline bool operator () (unsigned int a, unsigned int b) const
+    {
+        return (distances[a] < distances[b]) || ((distances[a] == distances[b]) && (a < b));
+    }
+};
+
+unsigned int PointCloudLibrary::Match(const PointCloud &cloud, float &score, MatchBuffers &buffers) const
+{
+    score = 0.0f;
+    unsigned int count = mClouds.size();
+    if (count == 0)
+        return NO_TEMPLATE;
+
+    //rank every template by the coarse index
+    float signature[COARSE_CELLS];
+    ComputeSignature(cloud, signature);
+    buffers.distances.resize(count);
+    buffers.order.resize(count);
+    for (unsigned int t=0; t<count; t++)
+    {
+        buffers.distances[t] = TrackKernels::SumAbsDifference(signature, &mSignatures[t * COARSE_CELLS], COARSE_CELLS);
+        buffers.order[t] = t;
+    }
+    unsigned int candidates = ((mCandidateCount > 0) && (mCandidateCount < count)) ? mCandidateCount : count;
+    _CoarseOrder order = { &buffers.distances[0] };
+    std::partial_sort(buffers.order.begin(), buffers.order.begin() + candidates, buffers.order.end(), order);
+
+    //the closest candidates first, they bound the matching of the rest early
+    float best = 1e30f;
+    unsigned int bestIndex = NO_TEMPLATE;
+    for (unsigned int c=0; c<candidates; c++)
+    {
+        unsigned int t = buffers.order[c];
+        float d = GreedyCloudMatch(cloud, mClouds[t], best);
+        if (d < best)
+        {
+            best = d;
+            bestIndex = t;
+        }
+    }
+    if (bestIndex != NO_TEMPLATE)
+        score = (best > 1.0f) ? 1.0f / best : 1.0f;
+    return bestIndex;
+}
@@ -0,0 +1,75 @@
+#ifndef POINT_CLOUD_LIBRARY_H_
+#define POINT_CLOUD_LIBRARY_H_
+
+#include "input/GesturePlatform.h"
+
+//---------------------------- class for the shape templates of the $P point cloud recognizer ----------------------------
+// a shape is any number of strokes (one finger after the other, or several fingers at once), the stroke order
+// and direction do not matter: the points are resampled to POINT_CLOUD_SIZE, scaled and centered, and two clouds
+// are compared by the greedy point matching of $P (Vatavu, Anthony, Wobbrock 2012)
+// a coarse index (occupancy of a 4x4 grid over the cloud) ranks the templates first, only the best candidates
+// are matched point by point, the matching stops a template as soon as it can not beat the best one so far
+// the library is read-only while matching, Match may run on several threads with their own MatchBuffers
+class PointCloudLibrary
+{
+public:
+    enum
+    {
+        POINT_CLOUD_SIZE    = 32,
+        COARSE_CELLS        = 16,
+        NO_TEMPLATE         = 0xffffffff,
+    };
+
+    // normalized shape, SoA for the matching kernels
+    struct PointCloud
+    {
+        float x[POINT_CLOUD_SIZE];
+        float y[POINT_CLOUD_SIZE];
+    };
+
+    // scratch of one Match call, sized by the first call for the current template count
+    struct MatchBuffers
+    {
+        std::vector<float> distances;
+        std::vector<unsigned int> order;
+    };
+
+    PointCloudLibrary();
+    ~PointCloudLibrary();
+
+    // strokes: stroke id of every point, the points of a stroke are consecutive, 0 for a single stroke
+    // returns false for a degenerate cloud (less than 2 points or no extent)
+    static bool Normalize(const float *x, const float *y, const unsigned int *strokes, unsigned int count, PointCloud &cloud);
+
+    // returns the template index, or NO_TEMPLATE for a degenerate shape
+    unsigned int AddTemplate(const char *name, const float *x, const float *y, const unsigned int *strokes, unsigned int count);
+    unsigned int AddTemplate(const char *name, const PointCloud &cloud);
+    void Clear();
+
+    inline unsigned int GetTemplateCount() const { return mClouds.size(); }
+    inline const char *GetTemplateName(unsigned int index) const { return mNames[index].c_str(); }
+    inline const PointCloud &GetTemplate(unsigned int index) const { return mClouds[index]; }
+
+    // templates matched point by point after the coarse ranking, 0 for all of them
+    inline void SetCandidateCount(unsigned int count) { mCandidateCount = count; }
+    inline unsigned int GetCandidateCount() const { return mCandidateCount; }
+
+    // best template for a normalized cloud, NO_TEMPLATE if the library is empty
+    // score is 1 / matching distance (at most 1, higher is better)
+    unsigned int Match(const PointCloud &cloud, float &score, MatchBuffers &buffers) const;
+
+    // matching distance of two clouds, stops once it reaches bound
+    static float GreedyCloudMatch(const PointCloud &a, const PointCloud &b, float bound);
+private:
+    static void ComputeSignature(const PointCloud &cloud, float *signature);
+    static float CloudDistance(const PointCloud &a, const PointCloud &b, unsigned int start, float bound, const float *remaining);
+    static float LowerBound(const float *nearest, unsigned int start, float *remaining);
+
+    std::vector<PointCloud> mClouds;
+    std::vector<std::string> mNames;
+    // COARSE_CELLS per template
+    std::vector<float> mSignatures;
+    unsigned int mCandidateCount;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "input/PointCloudRecognizer.h"
+#include "input/GestureEvents.h"
+#include "input/TouchQueue.h"
+#include "input/TouchTrackKernels.h"
+
+static unsigned int _INITIAL_STROKE_POINTS_     = 256;
+
+//--------------------------------------------- PointCloudRecognizer ---------------------------------------------
+PointCloudRecognizer::PointCloudRecognizer() : mLibrary(0), mMinScore(0.0f), mStrokeCount(0)
+{
+    mId = "PointCloudRecognizer";
+    mStrokeX.reserve(_INITIAL_STROKE_POINTS_);
+    mStrokeY.reserve(_INITIAL_STROKE_POINTS_);
+    mStrokeIds.reserve(_INITIAL_STROKE_POINTS_);
+}
+
+PointCloudRecognizer::~PointCloudRecognizer()
+{
+}
+
+bool PointCloudRecognizer::TryAddTouchQueueChanging(TouchQueue *queue, int changingMode, HexTime time)
+{
+    bool changed = BaseGestureRecognizer::TryAddTouchQueueChanging(queue, changingMode, time);
+    if (changingMode != TQC_RELEASE)
+        return changed;
+    //take the stroke now, the slot may be pressed again before the next Update
+    TouchQueueInfomation &info = FindQueueInfomation(queue);
+    if (info.IsEmpty())
+        return changed;
+    CaptureStroke(*queue);
+    UnlinkChanged(queue->GetTouchIndex());
+    return changed;
+}
+
+void PointCloudRecognizer::CaptureStroke(const TouchQueue &queue)
+{
+    const TouchTrack &track = queue.GetTouchTrack();
+    unsigned int count = track.Size();
+    if (count == 0)
+        return;
+    const float *x = track.GetX();
+    const float *y = track.GetY();
+    mStrokeX.insert(mStrokeX.end(), x, x + count);
+    mStrokeY.insert(mStrokeY.end(), y, y + count);
+    mStrokeIds.insert(mStrokeIds.end(), count, mStrokeCount);
+    mStrokeCount ++;
+}
+
+void PointCloudRecognizer::ClearStrokes()
+{
+    mStrokeX.clear();
+    mStrokeY.clear();
+    mStrokeIds.clear();
+    mStrokeCount = 0;
+}
+
+void PointCloudRecognizer::Reset()
+{
+    BaseGestureRecognizer::Reset();
+    ClearStrokes();
+}
+
+void PointCloudRecognizer::Update(HexTime currentTime)
+{
+    //the shape is complete once no touch of it is down any more
+    if (mStrokeCount && !mChangedCount)
+        RecognizeShape(currentTime);
+}
+
+void PointCloudRecognizer::RecognizeShape(HexTime time)
+{
+    unsigned int count = mStrokeX.size();
+    float minX, minY, maxX, maxY;
+    TrackKernels::BoundingBox(&mStrokeX[0], &mStrokeY[0], count, minX, minY, maxX, maxY);
+    bool steady = ((maxX - minX) <= (float)GetMaxSteadyMoveDistanceX()) && ((maxY - minY) <= (float)GetMaxSteadyMoveDistanceY());
+    PointCloudLibrary::PointCloud cloud;
+    if (mLibrary && !steady && PointCloudLibrary::Normalize(&mStrokeX[0], &mStrokeY[0], &mStrokeIds[0], count, cloud))
+    {
+        float score;
+        unsigned int index = mLibrary->Match(cloud, score, mMatchBuffers);
+        if ((index != PointCloudLibrary::NO_TEMPLATE) && (score >= mMinScore))
+        {
+            int x = (int)((minX + maxX) * 0.5f);
+            int y = (int)((minY + maxY) * 0.5f);
+            new (NewGestureEvent()) GestureShapeEvent(x, y, time, mStrokeCount, index, score);
+        }
+    }
+    ClearStrokes();
+}
@@ -0,0 +1,46 @@
+#ifndef POINT_CLOUD_RECOGNIZER_H_
+#define POINT_CLOUD_RECOGNIZER_H_
+
+#include "input/BaseGestureRecognizer.h"
+#include "input/PointCloudLibrary.h"
+
+//---------------------------- class for the template shape recognizer ----------------------------
+// collects the strokes of a shape, every touch pressed until the last one is released (several fingers count
+// as several strokes), then matches them against a PointCloudLibrary and reports a GestureShapeEvent
+// created by id "PointCloudRecognizer", it runs next to BaseGestureRecognizer on the same touch tracks
+// strokes that stay within the steady distance (taps) are not matched
+class PointCloudRecognizer : public BaseGestureRecognizer
+{
+public:
+    PointCloudRecognizer();
+    virtual ~PointCloudRecognizer();
+
+    // the templates to match against (not owned), one library may serve any number of recognizers
+    inline void SetTemplateLibrary(const PointCloudLibrary *library) { mLibrary = library; }
+    inline const PointCloudLibrary *GetTemplateLibrary() const { return mLibrary; }
+
+    // matches with a lower score are not reported, see PointCloudLibrary::Match
+    inline void SetMinScore(float score) { mMinScore = score; }
+    inline float GetMinScore() const { return mMinScore; }
+
+    virtual bool TryAddTouchQueueChanging(TouchQueue *queue, int changingMode, HexTime time);
+    virtual void Update(HexTime currentTime);
+    virtual void Reset();
+
+protected:
+    void CaptureStroke(const TouchQueue &queue);
+    void RecognizeShape(HexTime time);
+    void ClearStrokes();
+
+    const PointCloudLibrary *mLibrary;
+    float mMinScore;
+
+    //the released strokes of the current shape, the points of a stroke are consecutive
+    std::vector<float> mStrokeX;
+    std::vector<float> mStrokeY;
+    std::vector<unsigned int> mStrokeIds;
+    unsigned int mStrokeCount;
+    PointCloudLibrary::MatchBuffers mMatchBuffers;
+};
+
+#endif
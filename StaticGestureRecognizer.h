@@ -0,0 +1,86 @@
+#ifndef STATIC_GESTURE_RECOGNIZER_H_
+#define STATIC_GESTURE_RECOGNIZER_H_
+
+#include "input/GestureStates.h"
+#include "input/StaticTouchQueue.h"
+#include "input/GestureFixedPoint.h"
+
+static constexpr double _ConstexprSqrt(double x, double r, int iterations)
+{
+    return iterations ? _ConstexprSqrt(x, 0.5 * (r + x / r), iterations - 1) : r;
+}
+
+//---------------------------- recognizer specialized at compile time ----------------------------
+// the same state machine as BaseGestureRecognizer (GestureStates.h), with every threshold a constant of the policy,
+// the state table inline for Policy::MAX_CONTACTS slots, and the handlers final: a frame is one inlined call
+// note: the touch queues must be StaticTouchQueue<Policy> with slots below Policy::MAX_CONTACTS, see StaticTouchManager
+template <class Policy = DefaultGesturePolicy>
+class StaticGestureRecognizer final : public BaseGestureRecognizer
+{
+    template <class Machine> friend struct GestureStates;
+    typedef GestureStates<StaticGestureRecognizer> States;
+public:
+    StaticGestureRecognizer()
+    {
+        mId = "StaticGestureRecognizer";
+        UseTouchQueueInfomations(mInfomations, Policy::MAX_CONTACTS);
+    }
+
+    virtual void Update(HexTime currentTime) final { States::Update(*this, currentTime); }
+protected:
+    typedef StaticTouchQueue<Policy> TouchQueueType;
+    inline TouchQueueType &GetTouchQueue(const TouchQueueInfomation &info) const { return *static_cast<TouchQueueType *>(info.touchQueue); }
+
+    static constexpr HexTime GetMaxIntervalOfDoubleClick() { return Policy::MAX_INTERVAL_OF_DOUBLE_CLICK; }
+    static constexpr HexTime GetMinSteadyTimeForDrag() { return Policy::MIN_STEADY_TIME_FOR_DRAG; }
+    static constexpr HexTime GetMinTimeForLongTap() { return Policy::MIN_TIME_FOR_LONG_TAP; }
+    static constexpr HexTime GetMaxSwipeDuration() { return Policy::MAX_TIME_FOR_SWIPE; }
+    static constexpr float GetMinSpeedForSwipe()
+    {
+        return (float)_ConstexprSqrt((double)Policy::VIEWPORT_WIDTH * Policy::VIEWPORT_WIDTH + (double)Policy::VIEWPORT_HEIGHT * Policy::VIEWPORT_HEIGHT,
+                (double)Policy::VIEWPORT_WIDTH + Policy::VIEWPORT_HEIGHT, 32) / Policy::MAX_SWIPE_DURATION_FOR_WHOLE_SCREEN;
+    }
+    static constexpr float GetMinYChangePersentForArc() { return Policy::MIN_Y_CHANGE_PERSENT_FOR_ARC; }
+    static constexpr float GetMaxDistanceRatioForSteady() { return Policy::MAX_DISTANCE_RATIO_FOR_STEADY; }
+    static constexpr HexTime GetPredictionHorizon() { return Policy::PREDICTION_HORIZON; }
+#ifdef GESTURE_FIXED_POINT
+    //the same integers as BaseGestureRecognizer::InitializeDefaultParameters, folded in
+    static constexpr int GetMinXDistanceForArc()
+    {
+        return (int)FixedPoint::ScaleMillionths(Policy::VIEWPORT_WIDTH, FixedPoint::ToMillionths(Policy::MIN_X_RATIO_FOR_ARC));
+    }
+    static constexpr int GetMaxSteadyMoveDistanceX()
+    {
+        return (int)FixedPoint::ScaleMillionths(Policy::VIEWPORT_WIDTH, FixedPoint::ToMillionths(Policy::MAX_DISTANCE_RATIO_FOR_STEADY));
+    }
+    static constexpr int GetMaxSteadyMoveDistanceY()
+    {
+        return (int)FixedPoint::ScaleMillionths(Policy::VIEWPORT_HEIGHT, FixedPoint::ToMillionths(Policy::MAX_DISTANCE_RATIO_FOR_STEADY));
+    }
+    static constexpr unsigned long long GetMinSpeedSquaredForSwipe()
+    {
+        return FixedPoint::SwipeSpeedSquared(Policy::VIEWPORT_WIDTH, Policy::VIEWPORT_HEIGHT, FixedPoint::ToMillionths(Policy::MAX_SWIPE_DURATION_FOR_WHOLE_SCREEN));
+    }
+    static constexpr unsigned long long GetMaxDistanceSquaredForSteady()
+    {
+        return FixedPoint::SquaredLengthThreshold(FixedPoint::ToMillionths(Policy::MAX_DISTANCE_RATIO_FOR_STEADY));
+    }
+#else
+    static constexpr int GetMinXDistanceForArc() { return (int)(Policy::MIN_X_RATIO_FOR_ARC * Policy::VIEWPORT_WIDTH + 0.5f); }
+    static constexpr int GetMaxSteadyMoveDistanceX() { return (int)(Policy::MAX_DISTANCE_RATIO_FOR_STEADY * Policy::VIEWPORT_WIDTH + 0.5f); }
+    static constexpr int GetMaxSteadyMoveDistanceY() { return (int)(Policy::MAX_DISTANCE_RATIO_FOR_STEADY * Policy::VIEWPORT_HEIGHT + 0.5f); }
+#endif
+
+    virtual void OnTapState(TouchQueueInfomation &info, HexTime time) final { States::OnTapState(*this, info, time); }
+    virtual void OnMoveState(TouchQueueInfomation &info, HexTime time) final { States::OnMoveState(*this, info, time); }
+    virtual void OnSwipeState(TouchQueueInfomation &info, HexTime time) final { States::OnSwipeState(*this, info, time); }
+    virtual void OnLongTapState(TouchQueueInfomation &info, HexTime time) final { States::OnLongTapState(*this, info, time); }
+    virtual void OnDoubleTapState(TouchQueueInfomation &info, HexTime time) final { States::OnDoubleTapState(*this, info, time); }
+    virtual void OnDragState(TouchQueueInfomation &info, HexTime time) final { States::OnDragState(*this, info, time); }
+    virtual void OnDragMoveState(TouchQueueInfomation &info, HexTime time) final { States::OnDragMoveState(*this, info, time); }
+    virtual void OnMultiTouch(HexTime time) final { States::OnMultiTouch(*this, time); }
+private:
+    TouchQueueInfomation mInfomations[Policy::MAX_CONTACTS];
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef STATIC_TOUCH_MANAGER_H_
+#define STATIC_TOUCH_MANAGER_H_
+
+#include "input/TouchManager.h"
+#include "input/StaticGestureRecognizer.h"
+
+//---------------------------- inline storage of StaticTouchManager ----------------------------
+// a base class, so the queues exist before TouchManager is constructed with them
+template <class Policy>
+class StaticTouchStorage
+{
+protected:
+    StaticTouchStorage()
+    {
+        for (unsigned int i=0; i<Policy::MAX_CONTACTS; i++)
+        {
+            mStaticTouchQueues[i].SetTouchIndex(i);
+            mStaticTouchQueuePointers[i] = &mStaticTouchQueues[i];
+        }
+    }
+
+    StaticTouchQueue<Policy> mStaticTouchQueues[Policy::MAX_CONTACTS];
+    TouchQueue *mStaticTouchQueuePointers[Policy::MAX_CONTACTS];
+    StaticGestureRecognizer<Policy> mStaticGestureRecognizer;
+};
+
+//---------------------------- touch manager specialized at compile time ----------------------------
+// Policy::MAX_CONTACTS slots, every track and the recognizer state inline, StaticGestureRecognizer<Policy> is attached first
+// the ingestion ring, the slot map and the event queue are still allocated once at construction
+template <class Policy = DefaultGesturePolicy>
+class StaticTouchManager final : private StaticTouchStorage<Policy>, public TouchManager
+{
+public:
+    StaticTouchManager() : StaticTouchStorage<Policy>(), TouchManager(this->mStaticTouchQueuePointers, Policy::MAX_CONTACTS)
+    {
+        AttachGestureRecognizer(&this->mStaticGestureRecognizer);
+    }
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef STATIC_TOUCH_QUEUE_H_
+#define STATIC_TOUCH_QUEUE_H_
+
+#include "input/TouchQueue.h"
+#include "input/GesturePolicy.h"
+
+//---------------------------- touch queue with inline track storage ----------------------------
+// Policy::MAX_TRACK_POINTS points live in the object itself, longer tracks are simplified online
+// final, so calls through a StaticTouchQueue are not dispatched virtually
+template <class Policy = DefaultGesturePolicy>
+class StaticTouchQueue final : public TouchQueue
+{
+public:
+    static_assert(Policy::MAX_TRACK_POINTS >= 16, "a bounded track keeps at least 16 points");
+
+    StaticTouchQueue(unsigned int index = 0) :
+            TouchQueue(index, mX, mY, mTime, Policy::MAX_TRACK_POINTS, Policy::RECENT_TRACK_POINTS)
+    {}
+
+    inline void SetTouchIndex(unsigned int index) { mTouchIndex = index; }
+private:
+    float mX[Policy::MAX_TRACK_POINTS];
+    float mY[Policy::MAX_TRACK_POINTS];
+    HexTime mTime[Policy::MAX_TRACK_POINTS];
+};
+
+#endif
@@ -1,13 +1,42 @@
 #include "input/TouchManager.h"
+#include "input/GestureMemory.h"
 #include "input/BaseGestureRecognizer.h"
+#include "input/TouchTrace.h"
+
+#define _TOUCH_SAMPLE_RING_CAPACITY_    1024
+#define _RECOGNIZED_EVENT_RING_CAPACITY_ 256
+// slots of the sample ring only presses and releases may take, per contact
+#define _TOUCH_SAMPLE_HEADROOM_PER_SLOT_ 4
+// default arena: 512 points per contact, a few seconds of a 120 Hz digitizer
+#define _TRACK_ARENA_CHUNKS_PER_TOUCH_  16
 
 //--------------------------------------------------- TouchManager --------------------------------------------------
-TouchManager::TouchManager(unsigned int maxCount) : mMaxTouchQueueCount(maxCount), mGestureRecognizer(0)
+TouchManager::TouchManager(unsigned int maxCount, unsigned int trackArenaChunks) : mTouchSamples(_TOUCH_SAMPLE_RING_CAPACITY_),
+        mRecognizedEvents(_RECOGNIZED_EVENT_RING_CAPACITY_), mInputTimeRecognition(false), mInputTimeStarted(false), mTouchSlots(maxCount),
+        mMaxTouchQueueCount(maxCount), mTouchQueueBlock(0), mTrackArena(0), mReleasedTracks(0), mReleasedTrackCount(0), mPendingMoves(0),
+        mPendingMoveCount(0), mCoalescingDistance(0), mCoalescedSampleCount(0), mOwnsTouchQueues(true), mTraceRecorder(0), mTraceSink(0)
+{
+    assert(mMaxTouchQueueCount >= 1);
+    mPendingMoves = (TouchSample *)GestureMemory::AllocateZeroed(mMaxTouchQueueCount, sizeof(TouchSample));
+    mReleasedTracks = (bool *)GestureMemory::AllocateZeroed(mMaxTouchQueueCount, sizeof(bool));
+    InitializeSampleHeadroom();
+    mTrackArena = new TouchTrackArena(trackArenaChunks ? trackArenaChunks : mMaxTouchQueueCount * _TRACK_ARENA_CHUNKS_PER_TOUCH_);
+    mTouchQueueBlock = (TouchQueue *)GestureMemory::Allocate(sizeof(TouchQueue) * mMaxTouchQueueCount);
+    mTouchQueues = (TouchQueue **)GestureMemory::Allocate(sizeof(TouchQueue *) * mMaxTouchQueueCount);
+    for (unsigned int i=0; i<mMaxTouchQueueCount; i++)
+        mTouchQueues[i] = new (mTouchQueueBlock + i) TouchQueue(i, mTrackArena);
+}
+
+TouchManager::TouchManager(TouchQueue **touchQueues, unsigned int count) : mTouchSamples(_TOUCH_SAMPLE_RING_CAPACITY_),
+        mRecognizedEvents(_RECOGNIZED_EVENT_RING_CAPACITY_), mInputTimeRecognition(false), mInputTimeStarted(false), mTouchSlots(count),
+        mTouchQueues(touchQueues), mMaxTouchQueueCount(count), mTouchQueueBlock(0), mTrackArena(0), mReleasedTracks(0), mReleasedTrackCount(0),
+        mPendingMoves(0), mPendingMoveCount(0), mCoalescingDistance(0), mCoalescedSampleCount(0), mOwnsTouchQueues(false), mTraceRecorder(0), mTraceSink(0)
 {
     assert(mMaxTouchQueueCount >= 1);
-    mTouchQueues = (TouchQueue **)malloc(sizeof(TouchQueue *) * mMaxTouchQueueCount);
+    mPendingMoves = (TouchSample *)GestureMemory::AllocateZeroed(mMaxTouchQueueCount, sizeof(TouchSample));
+    InitializeSampleHeadroom();
     for (unsigned int i=0; i<mMaxTouchQueueCount; i++)
-        mTouchQueues[i] = new TouchQueue(i);
+        assert(mTouchQueues[i]->GetTouchIndex() == i);
 }
 
 TouchManager::~TouchManager()
@@ -18,93 +47,496 @@ TouchManager::~TouchManager()
     
 void TouchManager::Clear()
 {
-    for (unsigned int i=0; i<mMaxTouchQueueCount; i++)
-        delete mTouchQueues[i];
-    free(mTouchQueues);
+    if (mOwnsTouchQueues)
+    {
+        //the tracks give their runs back to the arena first
+        for (unsigned int i=0; i<mMaxTouchQueueCount; i++)
+            mTouchQueues[i]->~TouchQueue();
+        GestureMemory::Free(mTouchQueueBlock);
+        GestureMemory::Free(mTouchQueues);
+        delete mTrackArena;
+    }
     mTouchQueues = 0;
+    mTouchQueueBlock = 0;
+    mTrackArena = 0;
+    GestureMemory::Free(mReleasedTracks);
+    mReleasedTracks = 0;
+    mReleasedTrackCount = 0;
+    GestureMemory::Free(mPendingMoves);
+    mPendingMoves = 0;
+    mPendingMoveCount = 0;
     mActivedTouchQueue.Clear();
-    mGestureRecognizer = 0;
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+    {
+        if (mGestureRecognizers[i].owned)
+            delete mGestureRecognizers[i].recognizer;
+    }
+    mGestureRecognizers.clear();
     mGestureListeners.clear();
+    RebuildListenerTable();
 }
     
+void TouchManager::InitializeSampleHeadroom()
+{
+    mSampleHeadroom = mMaxTouchQueueCount * _TOUCH_SAMPLE_HEADROOM_PER_SLOT_;
+    if (mSampleHeadroom > mTouchSamples.GetCapacity() / 2)
+        mSampleHeadroom = mTouchSamples.GetCapacity() / 2;
+}
+
+void TouchManager::ResetSession()
+{
+    AssertConfigurable();
+    TouchSample sample;
+    while (mTouchSamples.Pop(sample))
+        ;
+    BaseGestureEvent event;
+    while (mRecognizedEvents.Pop(event))
+        ;
+    for (unsigned int slot=0; slot<mMaxTouchQueueCount; slot++)
+    {
+        mPendingMoves[slot].type = 0;
+        mTouchQueues[slot]->Clear();
+        if (mReleasedTracks)
+        {
+            mTouchQueues[slot]->ReleaseTrackStorage();
+            mReleasedTracks[slot] = false;
+        }
+    }
+    mReleasedTrackCount = 0;
+    mPendingMoveCount = 0;
+    mTouchSlots.Reset();
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+        mGestureRecognizers[i].recognizer->Reset();
+}
+
 void TouchManager::AddTouch(int x, int y, unsigned int touchIndex)
 {
-    if (touchIndex >= mMaxTouchQueueCount)
-        return;
-    mTouchQueues[touchIndex]->AddTouch(x, y, mTimer.GetTimeSlapped());
-    if (mGestureRecognizer)
-        mGestureRecognizer->TryAddTouchQueueChanging(mTouchQueues[touchIndex], 1, mTimer.GetTimeSlapped());
+    PushTouchSample(TouchSample::SAMPLE_PRESS, x, y, touchIndex);
 }
 
 void TouchManager::TouchMove(int x, int y, unsigned int touchIndex)
 {
-    if (touchIndex >= mMaxTouchQueueCount)
-        return;
-    mTouchQueues[touchIndex]->TouchMove(x, y, mTimer.GetTimeSlapped());
-    if (mGestureRecognizer)
-        mGestureRecognizer->TryAddTouchQueueChanging(mTouchQueues[touchIndex], 2, mTimer.GetTimeSlapped());
+    PushTouchSample(TouchSample::SAMPLE_MOVE, x, y, touchIndex);
 }
 
 void TouchManager::ReleaseTouch(int x, int y, unsigned int touchIndex)
 {
-    if (touchIndex >= mMaxTouchQueueCount)
+    PushTouchSample(TouchSample::SAMPLE_RELEASE, x, y, touchIndex);
+}
+
+void TouchManager::PushTouchSample(unsigned int type, int x, int y, unsigned int touchIndex)
+{
+    TouchSample sample;
+    sample.time = mTimer.GetTimeSlapped();
+    sample.x = x;
+    sample.y = y;
+    sample.touchIndex = touchIndex;
+    sample.type = type;
+    if (mInputTimeRecognition)
+    {
+        mInputTimeStarted.store(true, std::memory_order_relaxed);
+        ApplyTouchSample(sample);
+        if (!mTimer.IsTimerStopped())
+            RecognizeAt(sample.time);
+        return;
+    }
+    //a lost press or release leaves its contact stuck in the slot map, the moves give way to them
+    mTouchSamples.Push(sample, (type == TouchSample::SAMPLE_MOVE) ? mSampleHeadroom : 0);
+}
+
+void TouchManager::ApplyTouchSample(const TouchSample &sample)
+{
+    //the sample types match the trace record types and the changing types of the recognizer
+    if (mTraceRecorder)
+        mTraceRecorder->Record((__u8)sample.type, sample.x, sample.y, sample.touchIndex, sample.time);
+    unsigned int slot;
+    if (sample.type == TouchSample::SAMPLE_PRESS)
+        slot = mTouchSlots.Press(sample.touchIndex);
+    else
+        slot = mTouchSlots.Find(sample.touchIndex);
+    //every slot is held by another contact, or the id was never pressed
+    if (slot == TouchSlotMap::INVALID_SLOT)
+        return;
+    TouchQueue *queue = mTouchQueues[slot];
+    switch (sample.type)
+    {
+        case TouchSample::SAMPLE_PRESS:
+            DropPendingMove(slot);
+            //pressed again before its track went back, the contact reuses the storage
+            if (mReleasedTracks && mReleasedTracks[slot])
+            {
+                mReleasedTracks[slot] = false;
+                mReleasedTrackCount --;
+            }
+            queue->AddTouch(sample.x, sample.y, sample.time);
+            break;
+        case TouchSample::SAMPLE_MOVE:
+            if (CoalesceTouchMove(slot, sample))
+                return;
+            queue->TouchMove(sample.x, sample.y, sample.time);
+            break;
+        case TouchSample::SAMPLE_RELEASE:
+            //the release point is the endpoint, whatever was held before it
+            DropPendingMove(slot);
+            queue->ReleaseTouch(sample.x, sample.y, sample.time);
+            mTouchSlots.Release(slot);
+            if (mReleasedTracks && !mReleasedTracks[slot])
+            {
+                mReleasedTracks[slot] = true;
+                mReleasedTrackCount ++;
+            }
+            break;
+        default:
+            return;
+    }
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+        mGestureRecognizers[i].recognizer->TryAddTouchQueueChanging(queue, sample.type, sample.time);
+}
+
+bool TouchManager::CoalesceTouchMove(unsigned int slot, const TouchSample &sample)
+{
+    if (!mCoalescingDistance)
+        return false;
+    const TouchQueue &queue = *mTouchQueues[slot];
+    const TouchQueue::TrackStatistics &statistics = queue.GetTrackStatistics();
+    if (queue.IsActived() && statistics.pointCount)
+    {
+        int dx = sample.x - (int)statistics.lastPoint.point.x();
+        int dy = sample.y - (int)statistics.lastPoint.point.y();
+        int distance = (int)mCoalescingDistance;
+        if ((dx <= distance) && (dx >= -distance) && (dy <= distance) && (dy >= -distance))
+        {
+            TouchSample &pending = mPendingMoves[slot];
+            if (pending.type)
+                mCoalescedSampleCount ++;
+            else
+                mPendingMoveCount ++;
+            pending = sample;
+            return true;
+        }
+    }
+    //a significant move supersedes the held one
+    DropPendingMove(slot);
+    return false;
+}
+
+void TouchManager::DropPendingMove(unsigned int slot)
+{
+    TouchSample &pending = mPendingMoves[slot];
+    if (!pending.type)
+        return;
+    pending.type = 0;
+    mPendingMoveCount --;
+    mCoalescedSampleCount ++;
+}
+
+void TouchManager::FlushPendingMoves()
+{
+    for (unsigned int slot=0; mPendingMoveCount && (slot<mMaxTouchQueueCount); slot++)
+    {
+        TouchSample &pending = mPendingMoves[slot];
+        if (!pending.type)
+            continue;
+        pending.type = 0;
+        mPendingMoveCount --;
+        TouchQueue *queue = mTouchQueues[slot];
+        queue->TouchMove(pending.x, pending.y, pending.time);
+        for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+            mGestureRecognizers[i].recognizer->TryAddTouchQueueChanging(queue, TouchSample::SAMPLE_MOVE, pending.time);
+    }
+}
+
+void TouchManager::DrainTouchSamples()
+{
+    TouchSample sample;
+    while (mTouchSamples.Pop(sample))
+        ApplyTouchSample(sample);
+    //the last position of the frame is stored
+    FlushPendingMoves();
+}
+
+void TouchManager::RecognizeAt(HexTime time)
+{
+    //input thread: every recognizer steps at the time of the sample, the events go out in the order they were recognized
+    unsigned long long start = mTraceSink ? GestureStatsTimer::Now() : 0;
+    for (unsigned int r=0; r<mGestureRecognizers.size(); r++)
+    {
+        BaseGestureRecognizer *recognizer = mGestureRecognizers[r].recognizer;
+        recognizer->Update(time);
+        GestureEventQueue &events = recognizer->GetGestureEvents();
+        for (unsigned int e=0; e<events.Size(); e++)
+        {
+            if (mTraceSink)
+                mTraceSink->RecordEvent(r, *events[e]);
+            mRecognizedEvents.Push(*events[e]);
+        }
+        recognizer->ClearGestureEvents();
+    }
+    ReleaseIdleTracks();
+    if (mTraceSink)
+        mTraceSink->RecordUpdate(start, GestureStatsTimer::Now(), time);
+}
+
+void TouchManager::ReleaseIdleTracks()
+{
+    //a released track goes back to the arena as soon as every recognizer is done with it, not when a new contact
+    //claims its slot: the slot map hands out the slot released the longest ago, so that may take long
+    if (!mReleasedTrackCount)
+        return;
+    for (unsigned int slot=0; slot<mMaxTouchQueueCount; slot++)
+    {
+        if (!mReleasedTracks[slot])
+            continue;
+        bool tracked = false;
+        for (unsigned int r=0; (r<mGestureRecognizers.size()) && !tracked; r++)
+            tracked = mGestureRecognizers[r].recognizer->IsTrackingTouchSlot(slot);
+        if (tracked)
+            continue;
+        mTouchQueues[slot]->ReleaseTrackStorage();
+        mReleasedTracks[slot] = false;
+        mReleasedTrackCount --;
+    }
+}
+
+void TouchManager::DispatchGestureEvent(BaseGestureEvent *event)
+{
+    GESTURE_STATS_ONLY(mStats.eventsDispatched ++);
+    unsigned int type = event->GetEventType();
+    if (type >= GESTURE_MAX_TYPES)
+        return;
+    const std::vector<TouchManager::GestureListener *> &listeners = mListenersByType[type];
+    for (unsigned int i=0; i<listeners.size(); i++)
+    {
+        if (listeners[i]->HandleGestureEvent(event))
+            break;
+    }
+}
+
+void TouchManager::SetInputTimeRecognition(bool enabled)
+{
+    AssertConfigurable();
+    //the samples queued so far are applied the way they were reported
+    DrainTouchSamples();
+    mInputTimeRecognition = enabled;
+}
+
+void TouchManager::Poll()
+{
+    if (!mInputTimeRecognition)
+        return;
+    mInputTimeStarted.store(true, std::memory_order_relaxed);
+    FlushPendingMoves();
+    if (mTimer.IsTimerStopped())
         return;
-    mTouchQueues[touchIndex]->ReleaseTouch(x, y, mTimer.GetTimeSlapped());
-    if (mGestureRecognizer)
-        mGestureRecognizer->TryAddTouchQueueChanging(mTouchQueues[touchIndex], 3, mTimer.GetTimeSlapped());
+    HexTime time = mTimer.GetTimeSlapped();
+    if (mTraceRecorder)
+        mTraceRecorder->Record(TouchTraceRecord::TRACE_UPDATE, 0, 0, 0, time);
+    RecognizeAt(time);
 }
     
 void TouchManager::Update()
 {
-    if (mTimer.IsTimerStopped())
+#ifdef GESTURE_STATS
+    unsigned long long start = GestureStatsTimer::Now();
+    UpdateRecognition();
+    unsigned long long nanoseconds = GestureStatsTimer::Now() - start;
+    mStats.updateCount ++;
+    mStats.updateNanoseconds += nanoseconds;
+    if (nanoseconds > mStats.maxUpdateNanoseconds)
+        mStats.maxUpdateNanoseconds = nanoseconds;
+#else
+    UpdateRecognition();
+#endif
+}
+
+void TouchManager::UpdateRecognition()
+{
+    if (mInputTimeRecognition)
+    {
+        //recognized already, the listeners still run on the game thread
+        BaseGestureEvent event;
+        while (mRecognizedEvents.Pop(event))
+            DispatchGestureEvent(&event);
         return;
-    mGestureRecognizer->Update(mTimer.GetTimeSlapped());
-    BaseGestureEvent *event = mGestureRecognizer->GetCurrentGestureEvent();
-    if (!event)
+    }
+    //the tracks are fed even while no listener is registered, as before
+    DrainTouchSamples();
+    if (mTimer.IsTimerStopped())
         return;
-    for (unsigned int i=0; i<mGestureListeners.size(); i++)
+    HexTime time = mTimer.GetTimeSlapped();
+    if (mTraceRecorder)
+        mTraceRecorder->Record(TouchTraceRecord::TRACE_UPDATE, 0, 0, 0, time);
+    unsigned long long start = mTraceSink ? GestureStatsTimer::Now() : 0;
+    for (unsigned int r=0; r<mGestureRecognizers.size(); r++)
     {
-        mGestureListeners[i]->GestureEvent(event);
+        BaseGestureRecognizer *recognizer = mGestureRecognizers[r].recognizer;
+        recognizer->Update(time);
+        //drain every event of this frame in one batch
+        GestureEventQueue &events = recognizer->GetGestureEvents();
+        for (unsigned int e=0; e<events.Size(); e++)
+        {
+            if (mTraceSink)
+                mTraceSink->RecordEvent(r, *events[e]);
+            DispatchGestureEvent(events[e]);
+        }
+        recognizer->ClearGestureEvents();
     }
-    mGestureRecognizer->ResetCurrentGesture();
+    ReleaseIdleTracks();
+    if (mTraceSink)
+        mTraceSink->RecordUpdate(start, GestureStatsTimer::Now(), time);
+}
+
+void TouchManager::SetTraceSink(GestureTraceSink *sink)
+{
+    AssertConfigurable();
+    mTraceSink = sink;
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+        mGestureRecognizers[i].recognizer->SetTraceSink(sink, i);
+}
+
+void TouchManager::SetTrackMemoryBudget(unsigned int memoryBudget, unsigned int recentPoints)
+{
+    AssertConfigurable();
+    for (unsigned int i=0; i<mMaxTouchQueueCount; i++)
+        mTouchQueues[i]->SetTrackMemoryBudget(memoryBudget, recentPoints);
 }
 
-void TouchManager::RegisterGestureListener(TouchManager::GestureListener *listener)
+void TouchManager::RegisterGestureListener(TouchManager::GestureListener *listener, unsigned int typeMask, int priority)
 {
+    ListenerEntry *entry = 0;
     for (unsigned int i=0; i<mGestureListeners.size(); i++)
     {
-        if (listener == mGestureListeners[i])
-            return;
+        if (listener == mGestureListeners[i].listener)
+            entry = &mGestureListeners[i];
+    }
+    if (!entry)
+    {
+        mGestureListeners.push_back(ListenerEntry());
+        entry = &mGestureListeners.back();
+        entry->listener = listener;
     }
-    mGestureListeners.push_back(listener);
+    entry->typeMask = typeMask;
+    entry->priority = priority;
+    RebuildListenerTable();
     TryActiveTouchManager();
 }
 
 void TouchManager::UnRegisterGestureListener(TouchManager::GestureListener *listener)
 {
-    for (std::vector<TouchManager::GestureListener *>::iterator it = mGestureListeners.begin(); it != mGestureListeners.end(); it++)
+    for (std::vector<ListenerEntry>::iterator it = mGestureListeners.begin(); it != mGestureListeners.end(); it++)
     {
-        if (*it == listener)
+        if (it->listener == listener)
         {
             mGestureListeners.erase(it);
             break;
         }
     }
+    RebuildListenerTable();
     TryActiveTouchManager();
 }
 
+void TouchManager::RebuildListenerTable()
+{
+    //insertion by priority keeps the registration order within a priority, the lists are short
+    for (unsigned int type=0; type<GESTURE_MAX_TYPES; type++)
+    {
+        std::vector<TouchManager::GestureListener *> &listeners = mListenersByType[type];
+        listeners.clear();
+        std::vector<int> priorities;
+        for (unsigned int i=0; i<mGestureListeners.size(); i++)
+        {
+            const ListenerEntry &entry = mGestureListeners[i];
+            if (!(entry.typeMask & GESTURE_MASK(type)))
+                continue;
+            unsigned int position = listeners.size();
+            while ((position > 0) && (priorities[position - 1] < entry.priority))
+                position --;
+            listeners.insert(listeners.begin() + position, entry.listener);
+            priorities.insert(priorities.begin() + position, entry.priority);
+        }
+    }
+}
+
 void TouchManager::RegisterGestureRecognizer(const char *recognizerName)
 {
-    //delete the old one
-    if (mGestureRecognizer)
+    if (FindGestureRecognizer(recognizerName))
+        return;
+    //try create a new one
+    BaseGestureRecognizer *recognizer = BaseGestureRecognizer::Create(recognizerName);
+    if (!recognizer)
+        return;
+    recognizer->Initialize();
+    AddGestureRecognizer(recognizer, true);
+}
+
+void TouchManager::UnRegisterGestureRecognizer(const char *recognizerName)
+{
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
     {
-        if (strcmp(recognizerName, mGestureRecognizer->GetId()) == 0)
+        if (strcmp(recognizerName, mGestureRecognizers[i].recognizer->GetId()) == 0)
+        {
+            RemoveGestureRecognizer(i);
             return;
-        SAFE_DELETE(mGestureRecognizer);
+        }
     }
-    //try create a new one
-    mGestureRecognizer = BaseGestureRecognizer::Create(recognizerName);
-    mGestureRecognizer->Initialize();
+}
+
+void TouchManager::AttachGestureRecognizer(BaseGestureRecognizer *recognizer)
+{
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+    {
+        if (recognizer == mGestureRecognizers[i].recognizer)
+            return;
+    }
+    AddGestureRecognizer(recognizer, false);
+}
+
+void TouchManager::DetachGestureRecognizer(BaseGestureRecognizer *recognizer)
+{
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+    {
+        if (recognizer == mGestureRecognizers[i].recognizer)
+        {
+            RemoveGestureRecognizer(i);
+            return;
+        }
+    }
+}
+
+BaseGestureRecognizer *TouchManager::FindGestureRecognizer(const char *recognizerName) const
+{
+    for (unsigned int i=0; i<mGestureRecognizers.size(); i++)
+    {
+        if (strcmp(recognizerName, mGestureRecognizers[i].recognizer->GetId()) == 0)
+            return mGestureRecognizers[i].recognizer;
+    }
+    return 0;
+}
+
+void TouchManager::AddGestureRecognizer(BaseGestureRecognizer *recognizer, bool owned)
+{
+    AssertConfigurable();
+    RecognizerEntry entry;
+    entry.recognizer = recognizer;
+    entry.owned = owned;
+    mGestureRecognizers.push_back(entry);
+    recognizer->ReserveTouchQueueInfomations(mMaxTouchQueueCount);
+    recognizer->SetTraceSink(mTraceSink, mGestureRecognizers.size() - 1);
+    
+    TryActiveTouchManager();
+}
+
+void TouchManager::RemoveGestureRecognizer(unsigned int index)
+{
+    AssertConfigurable();
+    if (mGestureRecognizers[index].owned)
+        delete mGestureRecognizers[index].recognizer;
+    else
+        mGestureRecognizers[index].recognizer->SetTraceSink(0, 0);
+    mGestureRecognizers.erase(mGestureRecognizers.begin() + index);
+    //the numbers follow the attach order
+    for (unsigned int i=index; i<mGestureRecognizers.size(); i++)
+        mGestureRecognizers[i].recognizer->SetTraceSink(mTraceSink, i);
     
     TryActiveTouchManager();
 }
@@ -120,3 +552,53 @@ void TouchManager::TryActiveTouchManager()
     else
         mTimer.StopTimer();
 }
+
+void TouchManager::GetStatsSnapshot(GestureStatsSnapshot &snapshot) const
+{
+    snapshot.Reset();
+#ifdef GESTURE_STATS
+    snapshot = mStats;
+    for (unsigned int r=0; r<mGestureRecognizers.size(); r++)
+    {
+        const GestureRecognizerStats &stats = mGestureRecognizers[r].recognizer->GetStats();
+        for (unsigned int h=0; h<GestureRecognizerStats::HANDLER_COUNT; h++)
+        {
+            snapshot.handlerCalls[h] += stats.handlerCalls[h];
+            snapshot.handlerNanoseconds[h] += stats.handlerNanoseconds[h];
+        }
+        snapshot.changedQueueDepth += stats.changedQueueDepth;
+        if (stats.maxChangedQueueDepth > snapshot.maxChangedQueueDepth)
+            snapshot.maxChangedQueueDepth = stats.maxChangedQueueDepth;
+    }
+#endif
+    for (unsigned int r=0; r<mGestureRecognizers.size(); r++)
+        snapshot.eventsDropped += mGestureRecognizers[r].recognizer->GetGestureEvents().GetDroppedCount();
+    snapshot.eventsDropped += mRecognizedEvents.GetDroppedCount();
+    snapshot.samplesDropped = mTouchSamples.GetDroppedCount();
+    for (unsigned int i=0; i<mMaxTouchQueueCount; i++)
+    {
+        const TouchQueue *queue = mTouchQueues[i];
+        const TouchTrack &track = queue->GetTouchTrack();
+        if (queue->IsActived())
+            snapshot.activeTracks ++;
+        snapshot.trackPoints += track.Size();
+        if (track.Size() > snapshot.maxTrackPoints)
+            snapshot.maxTrackPoints = track.Size();
+        snapshot.trackBytes += track.GetCapacity() * TouchTrack::TRACK_POINT_SIZE;
+    }
+    if (mTrackArena)
+    {
+        snapshot.arenaBytes = mTrackArena->GetChunkCount() * TouchTrackArena::CHUNK_SIZE;
+        snapshot.arenaUsedBytes = mTrackArena->GetUsedChunkCount() * TouchTrackArena::CHUNK_SIZE;
+        snapshot.arenaOverflows = mTrackArena->GetOverflowCount();
+    }
+}
+
+void TouchManager::ResetStats()
+{
+#ifdef GESTURE_STATS
+    mStats.Reset();
+    for (unsigned int r=0; r<mGestureRecognizers.size(); r++)
+        mGestureRecognizers[r].recognizer->ResetStats();
+#endif
+}
@@ -2,13 +2,15 @@
 #define TOUCH_MANAGER_H_
 
 #include "input/TouchQueue.h"
-#include "HexTimeCounter.h"
-#include <vector.h>
+#include "input/TouchTrackArena.h"
+#include "input/TouchSampleRing.h"
+#include "input/TouchSlotMap.h"
+#include "input/GestureEvents.h"
+#include "input/GestureStats.h"
 
-using namespace HexmillEngine;
-
-class BaseGestureEvent;
 class BaseGestureRecognizer;
+class GestureTraceSink;
+class TouchTraceRecorder;
 
 class TouchManager
 {
@@ -20,38 +22,190 @@ public:
         
         virtual ~GestureListener() { }
         
+        // the plain callback, every event is passed on
         virtual void GestureEvent(BaseGestureEvent *event) = 0;
+        // override to consume events: return true and the listeners of lower priority do not get it
+        virtual bool HandleGestureEvent(BaseGestureEvent *event) { GestureEvent(event); return false; }
     };
 public:
-    TouchManager(unsigned int maxCount = 10);
+    // maxCount: number of simultaneous contacts, every contact gets a touch track slot
+    // the touch queues are laid out in one block, their tracks share one arena of trackArenaChunks chunks
+    // (TouchTrackArena::CHUNK_SIZE bytes each), 0 for 16 chunks per contact
+    // the track of a released contact goes back to the arena once no recognizer tracks its slot any more
+    TouchManager(unsigned int maxCount = 10, unsigned int trackArenaChunks = 0);
     virtual ~TouchManager();
     
+    // the input callbacks may come from the OS input thread: they only stamp the sample and push it
+    // into a lock-free ring, Update applies the samples on the game thread
+    // all three must be called from the same thread
+    // touchIndex is the pointer id of the platform, it may be sparse and large, see TouchSlotMap
     virtual void AddTouch(int x, int y, unsigned int touchIndex);
     virtual void TouchMove(int x, int y, unsigned int touchIndex);
     virtual void ReleaseTouch(int x, int y, unsigned int touchIndex);
 
     virtual void Update();
+
+    // back to a manager without any touch: the queued samples and events are dropped, every track, slot and
+    // recognizer state is cleared and the tracks give their storage back to the arena, the recognizers, listeners
+    // and settings stay, so one manager replays session after session (GestureBatchEngine), game thread without
+    // input in flight
+    void ResetSession();
+
+    // samples lost because the input thread outran Update, moves first: the last 4 slots per contact of the
+    // sample ring are kept for the presses and releases
+    inline unsigned int GetDroppedSampleCount() const { return mTouchSamples.GetDroppedCount(); }
+
+    // input time recognition: the input callbacks apply every sample at once and step the recognizers at the
+    // time of the sample, the events are queued to the game thread and Update only dispatches them to the listeners
+    // so no gesture waits for the next frame to be recognized, and the time thresholds are not rounded to frames
+    // the tracks and recognizers then belong to the input thread: once it reported the first sample, the recognizer
+    // set (Register/UnRegister/Attach/DetachGestureRecognizer), SetMoveCoalescing, SetTrackMemoryBudget,
+    // SetTraceRecorder, SetTraceSink, ResetSession and the mode itself are fixed (asserted), configure them before
+    // the input starts. The listeners may still change on the game thread, they are only called by Update
+    void SetInputTimeRecognition(bool enabled);
+    inline bool IsInputTimeRecognition() const { return mInputTimeRecognition; }
+    // input thread, input time recognition only: resolves the time outs (tap after the double click interval,
+    // long tap, swipe duration) without a new sample, call it whenever the input loop wakes up without input
+    void Poll();
+    // events lost because the input thread outran Update, input time recognition only
+    inline unsigned int GetDroppedEventCount() const { return mRecognizedEvents.GetDroppedCount(); }
+
+    // coalescing of high rate input: a move within distance pixels (on both axes) of the last stored point of its
+    // track is held back instead of stored, a later held move replaces it, a significant move or the release drops it
+    // the held move of every contact is stored at the end of the frame (Update, or Poll at input time), so the tracks
+    // keep their endpoints and the last position of every frame, 0 (default) stores every sample
+    // the trace recorder still gets every sample
+    inline void SetMoveCoalescing(unsigned int distance) { AssertConfigurable(); mCoalescingDistance = distance; }
+    inline unsigned int GetMoveCoalescing() const { return mCoalescingDistance; }
+    // moves merged away so far
+    inline unsigned int GetCoalescedSampleCount() const { return mCoalescedSampleCount; }
+
+    // instrumentation: Update cost, handler calls and cost, changed queue depth, events, track lengths and memory
+    // the counters exist in GESTURE_STATS builds only (see GestureStats.h), the gauges are read on every call
+    // take it on the thread that updates the recognizers (the input thread at input time)
+    void GetStatsSnapshot(GestureStatsSnapshot &snapshot) const;
+    void ResetStats();
+
+    //memory budget of every touch track in bytes, 0 for unlimited, see TouchQueue::SetTrackMemoryBudget
+    void SetTrackMemoryBudget(unsigned int memoryBudget, unsigned int recentPoints = 32);
+    // storage of the tracks, 0 when the touch queues come from the caller
+    inline const TouchTrackArena *GetTrackArena() const { return mTrackArena; }
     
-    inline bool IsEnabled() const { return mGestureRecognizer && (mGestureListeners.size() > 0); }
+    inline bool IsEnabled() const { return (mGestureRecognizers.size() > 0) && (mGestureListeners.size() > 0); }
 
-    void RegisterGestureListener(TouchManager::GestureListener *listener);
+    // typeMask: GESTURE_MASK(GESTURE_TAP) | ..., the listener gets the events of these types only
+    // the listeners of a type are called by descending priority, in registration order within a priority,
+    // until one consumes the event (GestureListener::HandleGestureEvent)
+    // registering a listener again changes its mask and priority
+    void RegisterGestureListener(TouchManager::GestureListener *listener, unsigned int typeMask = GESTURE_MASK_ALL, int priority = 0);
     void UnRegisterGestureListener(TouchManager::GestureListener *listener);
     
+    //several recognizers run side by side on the same touch tracks, each Update drives all of them in one pass
+    //their events reach the listeners in registration order
+    //create a recognizer by id (see BaseGestureRecognizer::RegisterFactory) and attach it, unless one with that id is attached
     void RegisterGestureRecognizer(const char *recognizerName);
+    void UnRegisterGestureRecognizer(const char *recognizerName);
+    //attach an existing recognizer, it is not owned
+    void AttachGestureRecognizer(BaseGestureRecognizer *recognizer);
+    void DetachGestureRecognizer(BaseGestureRecognizer *recognizer);
+
+    inline unsigned int GetGestureRecognizerCount() const { return mGestureRecognizers.size(); }
+    inline BaseGestureRecognizer *GetGestureRecognizer(unsigned int index = 0) const
+    {
+        return index < mGestureRecognizers.size() ? mGestureRecognizers[index].recognizer : 0;
+    }
+    BaseGestureRecognizer *FindGestureRecognizer(const char *recognizerName) const;
+
+    // the clock every touch is stamped with, switch it to manual time to feed recorded input
+    inline GestureClock &GetClock() { return mTimer; }
+
+    // record every input and update tick into a binary trace (not owned), 0 to stop recording
+    inline void SetTraceRecorder(TouchTraceRecorder *recorder) { AssertConfigurable(); mTraceRecorder = recorder; }
+    // timeline of the recognition (not owned), 0 to stop: the passes, the state transitions of every recognizer
+    // (numbered in attach order) and the events, see GestureTraceSink
+    void SetTraceSink(GestureTraceSink *sink);
 protected:
+    // fixed touch queues of count slots (not owned, see StaticTouchManager)
+    TouchManager(TouchQueue **touchQueues, unsigned int count);
+    struct RecognizerEntry
+    {
+        BaseGestureRecognizer *recognizer;
+        bool owned;
+    };
+
+    void AddGestureRecognizer(BaseGestureRecognizer *recognizer, bool owned);
+    void RemoveGestureRecognizer(unsigned int index);
+
     virtual void Clear();
     void TryActiveTouchManager();
+    // the state the input thread owns at input time may not change once it is running
+    inline void AssertConfigurable() const
+    {
+        assert(!mInputTimeRecognition || !mInputTimeStarted.load(std::memory_order_relaxed));
+    }
+    void InitializeSampleHeadroom();
+    void PushTouchSample(unsigned int type, int x, int y, unsigned int touchIndex);
+    void DrainTouchSamples();
+    void UpdateRecognition();
+    void ApplyTouchSample(const TouchSample &sample);
+    bool CoalesceTouchMove(unsigned int slot, const TouchSample &sample);
+    void DropPendingMove(unsigned int slot);
+    void FlushPendingMoves();
+    void RecognizeAt(HexTime time);
+    void ReleaseIdleTracks();
+    void DispatchGestureEvent(BaseGestureEvent *event);
     
-    HexTimeCounter mTimer;
+    GestureClock mTimer;
     
+    TouchSampleRing mTouchSamples;
+    // ring slots the moves leave to the presses and releases
+    unsigned int mSampleHeadroom;
+    // recognized on the input thread, dispatched by Update
+    SampleRing<BaseGestureEvent> mRecognizedEvents;
+    bool mInputTimeRecognition;
+    // set by the input thread with its first sample or Poll at input time
+    std::atomic<bool> mInputTimeStarted;
+
+    TouchSlotMap mTouchSlots;
     TouchQueue **mTouchQueues;
     unsigned int mMaxTouchQueueCount;
+    // owned queues: the objects side by side, their tracks in the arena
+    TouchQueue *mTouchQueueBlock;
+    TouchTrackArena *mTrackArena;
+    // per slot, owned queues only: released contact whose track still holds its storage
+    bool *mReleasedTracks;
+    unsigned int mReleasedTrackCount;
+
+    // held move per slot, type 0 for none
+    TouchSample *mPendingMoves;
+    unsigned int mPendingMoveCount;
+    unsigned int mCoalescingDistance;
+    unsigned int mCoalescedSampleCount;
     
     DataStructures::Queue<TouchQueue *> mActivedTouchQueue;
     
-    std::vector<TouchManager::GestureListener *> mGestureListeners;
+    struct ListenerEntry
+    {
+        TouchManager::GestureListener *listener;
+        unsigned int typeMask;
+        int priority;
+    };
+    void RebuildListenerTable();
+
+    // in registration order
+    std::vector<ListenerEntry> mGestureListeners;
+    // the subscribers of every event type, by priority, rebuilt when a listener (un)registers
+    std::vector<TouchManager::GestureListener *> mListenersByType[GESTURE_MAX_TYPES];
 
-    BaseGestureRecognizer *mGestureRecognizer;
+    std::vector<RecognizerEntry> mGestureRecognizers;
+    bool mOwnsTouchQueues;
+
+    TouchTraceRecorder *mTraceRecorder;
+    GestureTraceSink *mTraceSink;
+#ifdef GESTURE_STATS
+    // the manager part of the snapshot, the recognizers keep their own
+    GestureStatsSnapshot mStats;
+#endif
 };
 
 
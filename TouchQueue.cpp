@@ -1,9 +1,108 @@
 #include "input/TouchQueue.h"
+#include "input/TouchTrackKernels.h"
+
+#define _MIN_TRACK_POINTS_FOR_BUDGET_       16
+#define _DEFAULT_SIMPLIFY_TOLERANCE_        2.0f
+#define _MAX_SIMPLIFY_PASSES_               4
+// time constant of the velocity smoothing in ms, about two samples of a 120 Hz digitizer
+#define _VELOCITY_SMOOTHING_TIME_           16.0f
+// no prediction beyond this lead, nor for a contact silent for longer
+#define _MAX_PREDICTION_TIME_               100
+#define _MAX_PREDICTION_SILENCE_            50
+
+//the velocity of a new segment blends in by its duration, a lone slow sample does not stop a fast stroke at once
+static inline void _SmoothVelocity(float &velocityX, float &velocityY, float dx, float dy, int dt, bool first)
+{
+    float vx = dx * 1000.0f / (float)dt;
+    float vy = dy * 1000.0f / (float)dt;
+    if (first)
+    {
+        velocityX = vx;
+        velocityY = vy;
+        return;
+    }
+    float weight = (float)dt / ((float)dt + _VELOCITY_SMOOTHING_TIME_);
+    velocityX += (vx - velocityX) * weight;
+    velocityY += (vy - velocityY) * weight;
+}
+
+//------------------------------------------ TouchQueue::TrackStatistics -----------------------------------------
+void TouchQueue::TrackStatistics::Reset()
+{
+    pointCount = 0;
+    firstPoint = lastPoint = TouchPoint();
+    maxSegmentDistanceX = maxSegmentDistanceY = 0;
+    maxSegmentSpeed = 0.0f;
+#ifdef GESTURE_FIXED_POINT
+    maxSegmentSpeedSquared = 0;
+#endif
+    hasSegmentSpeed = false;
+    minX = minY = maxX = maxY = 0.0f;
+    pathLength = 0.0f;
+    velocityX = velocityY = 0.0f;
+}
+
+void TouchQueue::TrackStatistics::Append(const TouchPoint &p)
+{
+    if (pointCount++ == 0)
+    {
+        firstPoint = lastPoint = p;
+        minX = maxX = p.point.x();
+        minY = maxY = p.point.y();
+        return;
+    }
+    TouchPoint last = lastPoint;
+    lastPoint = p;
+    if (p.point.x() < minX)
+        minX = p.point.x();
+    if (p.point.x() > maxX)
+        maxX = p.point.x();
+    if (p.point.y() < minY)
+        minY = p.point.y();
+    if (p.point.y() > maxY)
+        maxY = p.point.y();
+
+    int tx = fabs(p.point.x() - last.point.x());
+    int ty = fabs(p.point.y() - last.point.y());
+    if (maxSegmentDistanceX < tx)
+        maxSegmentDistanceX = tx;
+    if (maxSegmentDistanceY < ty)
+        maxSegmentDistanceY = ty;
+
+    float length = (p.point - last.point).Length();
+    pathLength += length;
+    int dt = p.time - last.time;
+    if (dt == 0)
+        return;
+    _SmoothVelocity(velocityX, velocityY, p.point.x() - last.point.x(), p.point.y() - last.point.y(), dt, !hasSegmentSpeed);
+    float speed = length * 1000.0f / (float)dt;
+    if (speed > maxSegmentSpeed)
+        maxSegmentSpeed = speed;
+#ifdef GESTURE_FIXED_POINT
+    unsigned long long speedSquared = FixedPoint::SegmentSpeedSquared((long long)(p.point.x() - last.point.x()),
+            (long long)(p.point.y() - last.point.y()), dt);
+    if (speedSquared > maxSegmentSpeedSquared)
+        maxSegmentSpeedSquared = speedSquared;
+#endif
+    hasSegmentSpeed = true;
+}
 
 //--------------------------------------------------- TouchQueue --------------------------------------------------
-TouchQueue::TouchQueue(unsigned int index) : mActived(false), mTouchIndex(index)
+TouchQueue::TouchQueue(unsigned int index, TouchTrackArena *arena) : mMaxTrackPoints(0), mRecentPoints(0), mSimplifyTolerance(_DEFAULT_SIMPLIFY_TOLERANCE_),
+        mActived(false), mTouchIndex(index), mVersion(1), mFeaturesVersion(0), mArcVersion(0)
 {
-    mTouchTrack.ClearAndForceAllocation(32);
+    //an arena track takes its first chunk with the first point
+    mTouchTrack.SetArena(arena);
+    if (!arena)
+        mTouchTrack.ClearAndForceAllocation(32);
+}
+
+TouchQueue::TouchQueue(unsigned int index, float *x, float *y, HexTime *time, unsigned int capacity, unsigned int recentPoints) :
+        mTouchTrack(x, y, time, capacity), mMaxTrackPoints(0), mRecentPoints(0), mSimplifyTolerance(_DEFAULT_SIMPLIFY_TOLERANCE_),
+        mActived(false), mTouchIndex(index), mVersion(1), mFeaturesVersion(0), mArcVersion(0)
+{
+    assert(capacity >= _MIN_TRACK_POINTS_FOR_BUDGET_);
+    SetTrackMemoryBudget(capacity * TouchTrack::TRACK_POINT_SIZE, recentPoints);
 }
 
 TouchQueue::~TouchQueue()
@@ -14,28 +113,94 @@ TouchQueue::~TouchQueue()
 void TouchQueue::Clear()
 {
     mActived = false;
-    while (!mTouchTrack.IsEmpty())
-        mTouchTrack.Pop();
+    mTouchTrack.Clear();
+    mStatistics.Reset();
+    mVersion ++;
+    mSimplifyTolerance = _DEFAULT_SIMPLIFY_TOLERANCE_;
+}
+
+void TouchQueue::ReleaseTrackStorage()
+{
+    assert(!mActived);
+    Clear();
+    //the whole budget reserved by SetTrackMemoryBudget stays, the next contact of the slot starts at full capacity
+    //a heap block the arena could not serve is freed too, a slot does not hold on to the longest contact it saw
+    if (mTouchTrack.GetArena() && !mMaxTrackPoints)
+        mTouchTrack.ClearAndRelease();
+}
+
+void TouchQueue::SetTrackMemoryBudget(unsigned int memoryBudget, unsigned int recentPoints)
+{
+    //a fixed storage is never exceeded
+    unsigned int fixedBudget = mTouchTrack.GetCapacity() * TouchTrack::TRACK_POINT_SIZE;
+    if (mTouchTrack.IsFixed() && ((memoryBudget == 0) || (memoryBudget > fixedBudget)))
+        memoryBudget = fixedBudget;
+    if (memoryBudget == 0)
+    {
+        mMaxTrackPoints = mRecentPoints = 0;
+        return;
+    }
+    mMaxTrackPoints = memoryBudget / TouchTrack::TRACK_POINT_SIZE;
+    if (mMaxTrackPoints < _MIN_TRACK_POINTS_FOR_BUDGET_)
+        mMaxTrackPoints = _MIN_TRACK_POINTS_FOR_BUDGET_;
+    //at least half of the budget is left for the older part
+    mRecentPoints = recentPoints;
+    if (mRecentPoints > mMaxTrackPoints / 2)
+        mRecentPoints = mMaxTrackPoints / 2;
+    //allocate the whole budget up front, the track will not grow beyond it
+    if (mTouchTrack.IsEmpty())
+        mTouchTrack.ClearAndForceAllocation(mMaxTrackPoints);
+}
+
+void TouchQueue::CompactTrack()
+{
+    //simplify [1, recentStart) down to three quarters of the budget, with a growing tolerance
+    unsigned int target = mMaxTrackPoints - mMaxTrackPoints / 4;
+    unsigned int recentStart = mTouchTrack.Size() - mRecentPoints;
+    for (unsigned int pass=0; (pass < _MAX_SIMPLIFY_PASSES_) && (mTouchTrack.Size() > target); pass++)
+    {
+        recentStart -= mTouchTrack.SimplifyRange(1, recentStart, mSimplifyTolerance);
+        if (mTouchTrack.Size() > target)
+            mSimplifyTolerance *= 2.0f;
+    }
+    //fast and straight tracks do not simplify well, fall back to plain decimation
+    while (mTouchTrack.Size() > target)
+    {
+        unsigned int removed = mTouchTrack.DecimateRange(1, recentStart);
+        if (!removed)
+            break;
+        recentStart -= removed;
+    }
+}
+
+void TouchQueue::AppendTouchPoint(int x, int y, HexTime time)
+{
+    TouchPoint p(FastMath::Vector2((float)x, (float)y), time);
+    mStatistics.Append(p);
+    mTouchTrack.Push(p);
+    mVersion ++;
+    if (mMaxTrackPoints && (mTouchTrack.Size() >= mMaxTrackPoints))
+        CompactTrack();
 }
 
 void TouchQueue::AddTouch(int x, int y, HexTime time)
 {
     Clear();
     mActived = true;
-    mTouchTrack.Push(TouchPoint(FastMath::Vector2((float)x, (float)y), time));
+    AppendTouchPoint(x, y, time);
 }
 
 void TouchQueue::TouchMove(int x, int y, HexTime time)
 {
     if (mActived)
-        mTouchTrack.Push(TouchPoint(FastMath::Vector2((float)x, (float)y), time));
+        AppendTouchPoint(x, y, time);
 }
 
 void TouchQueue::ReleaseTouch(int x, int y, HexTime time)
 {
     if (!mActived)
         return;
-    mTouchTrack.Push(TouchPoint(FastMath::Vector2((float)x, (float)y), time));
+    AppendTouchPoint(x, y, time);
     mActived = false;
 }
 
@@ -50,49 +215,52 @@ void TouchQueue::ForceReleaseTouch()
         return;
     if (mTouchTrack.Size() == 1)
     {
-        TouchPoint &p = mTouchTrack[0];
+        TouchPoint p = mTouchTrack[0];
         ReleaseTouch((int)p.point.x(), (int)p.point.y(), p.time + 200);
     }
     mActived = false;
 }
 
+void TouchQueue::UpdateTrackFeatures()
+{
+    mFeatures.hasPoints = !mTouchTrack.IsEmpty();
+    GetTrackStartingPosition(mFeatures.startX, mFeatures.startY);
+    GetTrackEndingPosition(mFeatures.endX, mFeatures.endY);
+    GetAbsMaxMovingDistance(mFeatures.maxDistanceX, mFeatures.maxDistanceY);
+    mFeatures.startTime = mStatistics.firstPoint.time;
+    mFeatures.duration = GetDuration();
+    mFeatures.maxSpeed = mFeatures.avgSpeed = 0.0f;
+    mFeatures.hasSpeeds = GetMovingSpeeds(mFeatures.maxSpeed, mFeatures.avgSpeed);
+#ifdef GESTURE_FIXED_POINT
+    mFeatures.maxSpeedSquared = mStatistics.maxSegmentSpeedSquared;
+#endif
+    mFeaturesVersion = mVersion;
+}
+
 HexTime TouchQueue::GetDuration()
 {
     if (mTouchTrack.Size() < 2)
         return 0;
-    return mTouchTrack.PeekTail().time - mTouchTrack.Peek().time;
+    return mStatistics.lastPoint.time - mStatistics.firstPoint.time;
 }
 
 HexTime TouchQueue::GetCurrentDuration(HexTime current)
 {
     if (mTouchTrack.IsEmpty())
         return 0;
-    return current - mTouchTrack.Peek().time;
+    return current - mStatistics.firstPoint.time;
 }
 
 bool TouchQueue::GetMovingSpeeds(float &maxSpeed, float &avgSpeed)
 {
     if (mTouchTrack.Size() < 2)
         return false;
-    maxSpeed = 0.0f;
-    bool res = false;
-    for (unsigned int i=1; i<mTouchTrack.Size(); i++)
-    {
-        TouchPoint &p0 = mTouchTrack[i - 1];
-        TouchPoint &p1 = mTouchTrack[i];
-        int dt = p1.time - p0.time;
-        if (dt == 0)
-            continue;
-        float speed = (p1.point - p0.point).Length() * 1000.0f / (float)dt;
-        if (speed > maxSpeed)
-            maxSpeed = speed;
-        res = true;
-    }
+    maxSpeed = mStatistics.maxSegmentSpeed;
     avgSpeed = 0.0f;
-    if (res)
+    if (mStatistics.hasSegmentSpeed)
     {
-        TouchPoint p0 = mTouchTrack.Peek();
-        TouchPoint p1 = mTouchTrack.PeekTail();
+        const TouchPoint &p0 = mStatistics.firstPoint;
+        const TouchPoint &p1 = mStatistics.lastPoint;
         int dt = p1.time - p0.time;
         if (dt != 0)
             avgSpeed = (p1.point - p0.point).Length() * 1000.0f / (float)dt;
@@ -107,50 +275,130 @@ unsigned int TouchQueue::GetTouchPointCount() const
 
 bool TouchQueue::IsArcTrack(int minXDistance, float minYChangePersent, TouchQueue::ArcShape &arcType, Direction &direction)
 {
+    if ((mArcVersion == mVersion) && (mArcMinXDistance == minXDistance) && (mArcMinYChangePersent == minYChangePersent))
+    {
+        arcType = mArcType;
+        direction = mArcDirection;
+        return mArcResult;
+    }
+    mArcResult = DetectArcTrack(minXDistance, minYChangePersent, arcType, direction);
+    mArcType = arcType;
+    mArcDirection = direction;
+    mArcMinXDistance = minXDistance;
+    mArcMinYChangePersent = minYChangePersent;
+    mArcVersion = mVersion;
+    return mArcResult;
+}
+
+#ifdef GESTURE_FIXED_POINT
+bool TouchQueue::DetectArcTrack(int minXDistance, float minYChangePersent, TouchQueue::ArcShape &arcType, Direction &direction)
+{
+    //the float version below on integers: with the chord d = p1 - p0, the offset of a point p scaled by |d| is
+    //  cross = dx * (p.y - p0.y) - dy * (p.x - p0.x), the bias dirY scaled by |d| is dy
+    //so maxYDist / |d| >= minYChangePersent  <=>  max |cross - dy| * 10^6 >= minYChangePersent in millionths * |d|^2
     arcType = TouchQueue::ARC_NONE;
     direction = TouchQueue::DIR_NONE;
-    
+
     unsigned int trackCount = mTouchTrack.Size();
+    if (trackCount == 0)
+        return false;
 
-    TouchPoint &p0 = mTouchTrack[0];
-    TouchPoint &p1 = mTouchTrack[trackCount - 1];
+    long long x0 = (long long)mTouchTrack.X(0);
+    long long y0 = (long long)mTouchTrack.Y(0);
+    long long dx = (long long)mTouchTrack.X(trackCount - 1) - x0;
+    long long dy = (long long)mTouchTrack.Y(trackCount - 1) - y0;
+    long long distSquared = dx * dx + dy * dy;
 
     if (trackCount >= 4)
     {
-        int dx = abs((int)p1.point.x() - (int)p0.point.x());
-        if (dx > minXDistance)
+        if ((dx < 0 ? -dx : dx) > minXDistance)
         {
-            //identity matrix
-            FastMath::Matrix4x4f m;
-            //build rotation matrix
-            static FastMath::Point3f _x_vector = {1.0f, 0.0f, 0.0f};
-            FastMath::Point3f vec = {p1.point.x() - p0.point.x(), p1.point.y() - p0.point.y(), 0.0f};
-            FastMath::NormalizeVector3f(vec);
-            FastMath::CreateRotationMatrix4f(_x_vector, vec, m);
-            
-            std::vector<float> yArray;
-            unsigned int topYIndex = 0;
-            float maxYDist = -1e20f;
+            long long maxYDist = -1;
+            long long topY = 0;
             for (unsigned int i=1; i<trackCount - 1; i++)
             {
-                TouchPoint &p = mTouchTrack[i];
-                FastMath::Point3f pt = {p.point.x() - p0.point.x(), p.point.y()-p0.point.y(), 0.0f};
-                FastMath::Point3f myPt;
-                FastMath::PositionTransform3f(pt, m, myPt);
-                yArray.push_back(myPt[1]);
-                float yDist = myPt[1] - vec[1];
-                if (fabs(yDist) > maxYDist)
+                long long cross = dx * ((long long)mTouchTrack.Y(i) - y0) - dy * ((long long)mTouchTrack.X(i) - x0);
+                long long yDist = cross - dy;
+                if (yDist < 0)
+                    yDist = -yDist;
+                if (yDist > maxYDist)
                 {
-                    maxYDist = fabs(yDist);
-                    topYIndex = i;
+                    maxYDist = yDist;
+                    topY = cross;
                 }
             }
-            
-            float dist = (p1.point - p0.point).Length();
+            long long minPersent = (long long)(minYChangePersent * 1000000.0f + 0.5f);
+            if (maxYDist * FixedPoint::MILLION >= minPersent * distSquared)
+            {
+                if (topY > 0)
+                    arcType = TouchQueue::ARC_UP;
+                else
+                    arcType = TouchQueue::ARC_DOWN;
+
+                if (dx > 0)
+                    direction = TouchQueue::DIR_RIGHT;
+                else
+                    direction = TouchQueue::DIR_LEFT;
+
+                return true;
+            }
+        }
+    }
+    //not a movement in curve, the octant of the chord: axis within 22.5 degree (tan = 27146 / 65536), diagonal else
+    //a zero chord is top, like the float version
+    long long ax = dx < 0 ? -dx : dx;
+    long long ay = dy < 0 ? -dy : dy;
+    if (distSquared == 0)
+        direction = TouchQueue::DIR_TOP;
+    else if (ay * FixedPoint::Q16_ONE <= ax * 27146)
+        direction = (dx > 0) ? TouchQueue::DIR_RIGHT : TouchQueue::DIR_LEFT;
+    else if (ax * FixedPoint::Q16_ONE <= ay * 27146)
+        direction = (dy > 0) ? TouchQueue::DIR_BOTTOM : TouchQueue::DIR_TOP;
+    else if (dx > 0)
+        direction = (dy > 0) ? TouchQueue::DIR_BOTTOM_RIGHT : TouchQueue::DIR_TOP_RIGHT;
+    else
+        direction = (dy > 0) ? TouchQueue::DIR_BOTTOM_LEFT : TouchQueue::DIR_TOP_LEFT;
+    return false;
+}
+#else
+bool TouchQueue::DetectArcTrack(int minXDistance, float minYChangePersent, TouchQueue::ArcShape &arcType, Direction &direction)
+{
+    arcType = TouchQueue::ARC_NONE;
+    direction = TouchQueue::DIR_NONE;
+    
+    unsigned int trackCount = mTouchTrack.Size();
+    if (trackCount == 0)
+        return false;
+
+    TouchPoint p0 = mTouchTrack[0];
+    TouchPoint p1 = mTouchTrack[trackCount - 1];
+
+    //normalized chord from the first to the last point
+    float dirX = p1.point.x() - p0.point.x();
+    float dirY = p1.point.y() - p0.point.y();
+    float dist = sqrtf(dirX * dirX + dirY * dirY);
+    if (dist > 0.0f)
+    {
+        dirX /= dist;
+        dirY /= dist;
+    }
+
+    if (trackCount >= 4)
+    {
+        int dx = abs((int)p1.point.x() - (int)p0.point.x());
+        if (dx > minXDistance)
+        {
+            //perpendicular offset of the inner points to the chord, one pass over the track without any allocation
+            //note: the distance is measured against dirY, as the former rotation-matrix version did
+            float maxYDist;
+            float topY;
+            TrackKernels::MaxPerpendicularOffset(mTouchTrack.GetX() + 1, mTouchTrack.GetY() + 1, trackCount - 2,
+                    p0.point.x(), p0.point.y(), dirX, dirY, dirY, maxYDist, topY);
+
             float yChangePersent = maxYDist / dist;
             if (yChangePersent >= minYChangePersent)
             {
-                if (yArray[topYIndex] > 0)
+                if (topY > 0)
                     arcType = TouchQueue::ARC_UP;
                 else
                     arcType = TouchQueue::ARC_DOWN;
@@ -165,65 +413,63 @@ bool TouchQueue::IsArcTrack(int minXDistance, float minYChangePersent, TouchQueu
         }
     }
     //not a movement in curve, determin the direction
-    static const FastMath::Point3f _const_directions[8] =
+    static const float _const_directions[8][2] =
     {
-        {0.0f, -1.0f, 0.0f},                //top
-        {0.707107f, -0.707107f, 0.0f},      //right-top
-        {1.0f, 0.0f, 0.0f},                 //right
-        {0.707107f, 0.707107f, 0.0f},       //right-bottom
-        {0.0f, 1.0f, 0.0f},                 //bottom
-        {-0.707107f, 0.707107f, 0.0f},      //left-bottom
-        {-1.0f, 0.0f, 0.0f},                //left
-        {-0.707107f, -0.707107f, 0.0f}      //left-top
+        {0.0f, -1.0f},                  //top
+        {0.707107f, -0.707107f},        //right-top
+        {1.0f, 0.0f},                   //right
+        {0.707107f, 0.707107f},         //right-bottom
+        {0.0f, 1.0f},                   //bottom
+        {-0.707107f, 0.707107f},        //left-bottom
+        {-1.0f, 0.0f},                  //left
+        {-0.707107f, -0.707107f}        //left-top
+    };
+    static const TouchQueue::Direction _directions[8] =
+    {
+        TouchQueue::DIR_TOP,
+        TouchQueue::DIR_TOP_RIGHT,
+        TouchQueue::DIR_RIGHT,
+        TouchQueue::DIR_BOTTOM_RIGHT,
+        TouchQueue::DIR_BOTTOM,
+        TouchQueue::DIR_BOTTOM_LEFT,
+        TouchQueue::DIR_LEFT,
+        TouchQueue::DIR_TOP_LEFT,
     };
     
-    FastMath::Point3f vec = {p1.point.x() - p0.point.x(), p1.point.y() - p0.point.y(), 0.0f};
-    FastMath::NormalizeVector3f(vec);
-    
-    unsigned int closestIndex = 100;
+    unsigned int closestIndex = 0;
     float maxDot = -1e20f;
     for (unsigned int i=0; i<8; i++)
     {
-        float dot = FastMath::VectorDotProduct3f(vec, _const_directions[i]);
+        float dot = dirX * _const_directions[i][0] + dirY * _const_directions[i][1];
         if (dot > maxDot)
         {
             maxDot = dot;
             closestIndex = i;
         }
     }
-    switch (closestIndex)
-    {
-        case 0:
-            direction = TouchQueue::DIR_TOP;
-            break;
-        case 1:
-            direction = TouchQueue::DIR_TOP_RIGHT;
-            break;
-        case 2:
-            direction = TouchQueue::DIR_RIGHT;
-            break;
-        case 3:
-            direction = TouchQueue::DIR_BOTTOM_RIGHT;
-            break;
-        case 4:
-            direction = TouchQueue::DIR_BOTTOM;
-            break;
-        case 5:
-            direction = TouchQueue::DIR_BOTTOM_LEFT;
-            break;
-        case 6:
-            direction = TouchQueue::DIR_LEFT;
-            break;
-        case 7:
-            direction = TouchQueue::DIR_TOP_LEFT;
-            break;
-        default:
-            direction = TouchQueue::DIR_NONE;
-            assert(false);
-            break;
-    }
+    direction = _directions[closestIndex];
     return false;
 }
+#endif
+
+bool TouchQueue::PredictPosition(HexTime current, HexTime horizon, int &x, int &y) const
+{
+    if (!mActived || (mStatistics.pointCount == 0) || !mStatistics.hasSegmentSpeed)
+        return false;
+    const TouchPoint &last = mStatistics.lastPoint;
+    int silence = current - last.time;
+    if (silence < 0)
+        silence = 0;
+    //resting, the last velocity says nothing about where it goes next
+    if (silence > _MAX_PREDICTION_SILENCE_)
+        return false;
+    int lead = silence + (int)horizon;
+    if (lead > _MAX_PREDICTION_TIME_)
+        lead = _MAX_PREDICTION_TIME_;
+    x = (int)floorf(last.point.x() + mStatistics.velocityX * (float)lead / 1000.0f + 0.5f);
+    y = (int)floorf(last.point.y() + mStatistics.velocityY * (float)lead / 1000.0f + 0.5f);
+    return true;
+}
 
 void TouchQueue::GetAbsMaxMovingDistance(int &x, int &y)
 {
@@ -233,18 +479,8 @@ void TouchQueue::GetAbsMaxMovingDistance(int &x, int &y)
     }
     else
     {
-        x = y = -1e20;
-        for (unsigned int i=1; i<mTouchTrack.Size(); i++)
-        {
-            TouchPoint &p1 = mTouchTrack[i];
-            TouchPoint &p0 = mTouchTrack[i - 1];
-            int tx = fabs(p1.point.x() - p0.point.x());
-            int ty = fabs(p1.point.y() - p0.point.y());
-            if (x < tx)
-                x = tx;
-            if (y < ty)
-                y = ty;
-        }
+        x = mStatistics.maxSegmentDistanceX;
+        y = mStatistics.maxSegmentDistanceY;
     }
 }
 
@@ -256,9 +492,8 @@ void TouchQueue::GetTrackStartingPosition(int &x, int &y)
     }
     else
     {
-        TouchPoint &p = mTouchTrack[0];
-        x = p.point.x();
-        y = p.point.y();
+        x = mStatistics.firstPoint.point.x();
+        y = mStatistics.firstPoint.point.y();
     }
 }
 
@@ -270,8 +505,64 @@ void TouchQueue::GetTrackEndingPosition(int &x, int &y)
     }
     else
     {
-        TouchPoint &p = mTouchTrack[mTouchTrack.Size() - 1];
-        x = p.point.x();
-        y = p.point.y();
+        x = mStatistics.lastPoint.point.x();
+        y = mStatistics.lastPoint.point.y();
+    }
+}
+
+void TouchQueue::GetTrackBoundingBox(int &minX, int &minY, int &maxX, int &maxY)
+{
+    minX = mStatistics.minX;
+    minY = mStatistics.minY;
+    maxX = mStatistics.maxX;
+    maxY = mStatistics.maxY;
+}
+
+void TouchQueue::GetTrackCentroid(float &x, float &y)
+{
+    TrackKernels::Centroid(mTouchTrack.GetX(), mTouchTrack.GetY(), mTouchTrack.Size(), x, y);
+}
+
+void TouchQueue::ComputeTrackStatistics(unsigned int first, unsigned int count, TouchQueue::TrackStatistics &statistics)
+{
+    statistics.Reset();
+    unsigned int size = mTouchTrack.Size();
+    if (first >= size)
+        return;
+    if ((count == 0) || (count > size - first))
+        count = size - first;
+    const float *x = mTouchTrack.GetX() + first;
+    const float *y = mTouchTrack.GetY() + first;
+    const HexTime *time = mTouchTrack.GetTime() + first;
+
+    statistics.pointCount = count;
+    statistics.firstPoint = mTouchTrack[first];
+    statistics.lastPoint = mTouchTrack[first + count - 1];
+    float maxX, maxY;
+    TrackKernels::MaxSegmentDistance(x, y, count, maxX, maxY);
+    statistics.maxSegmentDistanceX = (int)maxX;
+    statistics.maxSegmentDistanceY = (int)maxY;
+    statistics.hasSegmentSpeed = TrackKernels::MaxSegmentSpeed(x, y, time, count, statistics.maxSegmentSpeed);
+#ifdef GESTURE_FIXED_POINT
+    for (unsigned int i=1; i<count; i++)
+    {
+        int dt = time[i] - time[i - 1];
+        if (dt == 0)
+            continue;
+        unsigned long long speedSquared = FixedPoint::SegmentSpeedSquared((long long)(x[i] - x[i - 1]), (long long)(y[i] - y[i - 1]), dt);
+        if (speedSquared > statistics.maxSegmentSpeedSquared)
+            statistics.maxSegmentSpeedSquared = speedSquared;
+    }
+#endif
+    TrackKernels::BoundingBox(x, y, count, statistics.minX, statistics.minY, statistics.maxX, statistics.maxY);
+    statistics.pathLength = TrackKernels::PathLength(x, y, count);
+    bool firstSegment = true;
+    for (unsigned int i=1; i<count; i++)
+    {
+        int dt = time[i] - time[i - 1];
+        if (dt == 0)
+            continue;
+        _SmoothVelocity(statistics.velocityX, statistics.velocityY, x[i] - x[i - 1], y[i] - y[i - 1], dt, firstSegment);
+        firstSegment = false;
     }
 }
@@ -1,26 +1,14 @@
 #ifndef TOUCH_QUEUE_H_
 #define TOUCH_QUEUE_H_
 
-#include "HexmillEngine.h"
-#include "DS_Queue.h"
-
-using namespace HexmillEngine;
-
-struct TouchPoint
-{
-    TouchPoint() : point(FastMath::Vector2::Zero()), time(0) {}
-    TouchPoint(const FastMath::Vector2 &p, HexTime t) : point(p), time(t) {}
-    
-    inline bool IsValid() { return time != 0; }
-    
-    FastMath::Vector2 point;
-    HexTime time;
-};
+#include "input/GesturePlatform.h"
+#include "input/TouchTrack.h"
+#include "input/GestureFixedPoint.h"
 
 class TouchQueue
 {
 public:
-    typedef DataStructures::Queue<TouchPoint> TouchTrack;
+    typedef ::TouchTrack TouchTrack;
     
     enum ArcShape
     {
@@ -41,11 +29,69 @@ public:
         DIR_LEFT            = 0x00000040,
         DIR_TOP_LEFT        = 0x00000080,
     };
+
+    // running values of the track, updated on every new point, so the queries do not rescan the track
+    struct TrackStatistics
+    {
+        TrackStatistics() { Reset(); }
+
+        void Reset();
+        void Append(const TouchPoint &p);
+
+        unsigned int pointCount;    // every point appended, the track itself may hold less
+        TouchPoint firstPoint;
+        TouchPoint lastPoint;
+        int maxSegmentDistanceX;
+        int maxSegmentDistanceY;
+        float maxSegmentSpeed;
+#ifdef GESTURE_FIXED_POINT
+        unsigned long long maxSegmentSpeedSquared;  // FixedPoint::SegmentSpeedSquared, what the recognizers decide on
+#endif
+        bool hasSegmentSpeed;       // at least one segment with a non-zero duration
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        float pathLength;
+        // motion model of the contact: velocity in pixels per second, smoothed over the recent segments
+        float velocityX;
+        float velocityY;
+    };
+    // what the recognizers query every frame, computed once after each change of the queue
+    // every state handler and every recognizer of the frame share it, see GetTrackFeatures
+    struct TrackFeatures
+    {
+        bool hasPoints;
+        int startX;                 // GetTrackStartingPosition
+        int startY;
+        int endX;                   // GetTrackEndingPosition
+        int endY;
+        int maxDistanceX;           // GetAbsMaxMovingDistance
+        int maxDistanceY;
+        HexTime startTime;
+        HexTime duration;           // GetDuration
+        bool hasSpeeds;             // GetMovingSpeeds
+        float maxSpeed;
+        float avgSpeed;
+#ifdef GESTURE_FIXED_POINT
+        unsigned long long maxSpeedSquared;
+#endif
+
+        // GetCurrentDuration
+        inline HexTime GetCurrentDuration(HexTime current) const { return hasPoints ? current - startTime : 0; }
+    };
 public:
-    TouchQueue(unsigned int index);
+    // arena: the track storage comes from it and goes back with ReleaseTrackStorage, see TouchTrackArena,
+    // 0 for a track on the heap
+    TouchQueue(unsigned int index, TouchTrackArena *arena = 0);
     virtual ~TouchQueue();
     
+    // the storage stays for the next contact of the slot
     virtual void Clear();
+    // cleared, and an unbounded arena track gives its storage back: the run to the arena, a block the arena could
+    // not serve to the heap. TouchManager calls it once the contact is released and no recognizer tracks the slot,
+    // a released queue only, a track bounded by SetTrackMemoryBudget keeps its reserved run
+    void ReleaseTrackStorage();
     
     virtual inline bool IsActived() const { return mActived; }
     virtual inline unsigned int GetTouchIndex() const { return mTouchIndex; }
@@ -58,6 +104,12 @@ public:
     //try deactive the queue, after these calls, the input should be ignored, even the touch event still triggered
     virtual void ForceReleaseTouch(int x, int y, HexTime time);
     virtual void ForceReleaseTouch();
+
+    //bound the stored track to about memoryBudget bytes, 0 for unlimited (default)
+    //when the budget is reached the older points are simplified online, the first point and the last recentPoints stay untouched
+    //the track statistics (speeds, extents, endpoints) always cover every point
+    void SetTrackMemoryBudget(unsigned int memoryBudget, unsigned int recentPoints = 32);
+    inline unsigned int GetMaxTrackPoints() const { return mMaxTrackPoints; }
     
     HexTime GetDuration();
     HexTime GetCurrentDuration(HexTime current);
@@ -67,10 +119,53 @@ public:
     void GetAbsMaxMovingDistance(int &x, int &y);
     void GetTrackStartingPosition(int &x, int &y);
     void GetTrackEndingPosition(int &x, int &y);
+    void GetTrackBoundingBox(int &minX, int &minY, int &maxX, int &maxY);
+    inline float GetTrackPathLength() const { return mStatistics.pathLength; }
+    inline const TrackStatistics &GetTrackStatistics() const { return mStatistics; }
+    // where the contact will be horizon ms after current, extrapolated from the last point with the smoothed velocity
+    // returns false, x and y untouched, when there is nothing to extrapolate: a released contact, no timed segment yet,
+    // or a contact that reported nothing for a while (resting)
+    bool PredictPosition(HexTime current, HexTime horizon, int &x, int &y) const;
+    inline const TouchTrack &GetTouchTrack() const { return mTouchTrack; }
+    inline const TrackFeatures &GetTrackFeatures()
+    {
+        if (mFeaturesVersion != mVersion)
+            UpdateTrackFeatures();
+        return mFeatures;
+    }
+
+    // full scans over the stored track with the vectorized kernels, for offline analysis of long tracks
+    void GetTrackCentroid(float &x, float &y);
+    // statistics of the stored points [first, first + count), the whole track for count 0
+    void ComputeTrackStatistics(unsigned int first, unsigned int count, TrackStatistics &statistics);
 protected:
+    // track in a fixed storage of capacity points (not owned, see StaticTouchQueue), bounded by SetTrackMemoryBudget
+    TouchQueue(unsigned int index, float *x, float *y, HexTime *time, unsigned int capacity, unsigned int recentPoints);
+
+    void AppendTouchPoint(int x, int y, HexTime time);
+    void CompactTrack();
+    void UpdateTrackFeatures();
+    bool DetectArcTrack(int minXDistance, float minYChangePersent, TouchQueue::ArcShape &arcType, Direction &direction);
+
     TouchTrack mTouchTrack;
+    TrackStatistics mStatistics;
+    unsigned int mMaxTrackPoints;
+    unsigned int mRecentPoints;
+    float mSimplifyTolerance;
     bool mActived;
     unsigned int mTouchIndex;
+
+    // bumped on every change of the track, the cached values below are valid for one version
+    unsigned int mVersion;
+    unsigned int mFeaturesVersion;
+    TrackFeatures mFeatures;
+    // last IsArcTrack query, the recognizers of a frame ask with the same thresholds
+    unsigned int mArcVersion;
+    int mArcMinXDistance;
+    float mArcMinYChangePersent;
+    bool mArcResult;
+    ArcShape mArcType;
+    Direction mArcDirection;
 };
 
 
@@ -0,0 +1,113 @@
+#ifndef TOUCH_SAMPLE_RING_H_
+#define TOUCH_SAMPLE_RING_H_
+
+#include "input/GesturePlatform.h"
+#include "input/GestureMemory.h"
+#include <atomic>
+
+// raw touch input, stamped on the thread that reported it
+struct TouchSample
+{
+    enum SampleType
+    {
+        SAMPLE_PRESS    = 1,
+        SAMPLE_MOVE     = 2,
+        SAMPLE_RELEASE  = 3,
+    };
+
+    HexTime time;
+    int x;
+    int y;
+    unsigned int touchIndex;
+    unsigned int type;
+};
+
+//---------------------------- single producer single consumer ring ----------------------------
+// the input thread pushes, the game thread drains, no lock on either side
+// Push and Pop are wait-free: one relaxed load of the own index, one acquire load of the other index
+// only when the cached copy says full / empty, and one release store
+// when the ring is full the item is dropped and counted, the capacity is rounded up to a power of two
+// a push may keep reserve slots free for the items that must not be lost (TouchManager: presses and releases)
+// Item is a trivially copyable record: touch samples in, gesture events out (see TouchManager)
+template <class Item>
+class SampleRing
+{
+public:
+    SampleRing(unsigned int capacity) : mTail(0), mCachedHead(0), mDroppedCount(0), mHead(0), mCachedTail(0)
+    {
+        assert(capacity >= 1 && capacity <= 0x80000000u);
+        mCapacity = 1;
+        while (mCapacity < capacity)
+            mCapacity <<= 1;
+        mMask = mCapacity - 1;
+        mItems = (Item *)GestureMemory::Allocate(sizeof(Item) * mCapacity);
+        assert(mItems);
+    }
+
+    ~SampleRing()
+    {
+        GestureMemory::Free(mItems);
+    }
+
+    // producer side, fails when fewer than reserve + 1 slots are free
+    inline bool Push(const Item &item, unsigned int reserve = 0)
+    {
+        assert(reserve < mCapacity);
+        unsigned int tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead + reserve >= mCapacity)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead + reserve >= mCapacity)
+            {
+                mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        mItems[tail & mMask] = item;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    inline bool Pop(Item &item)
+    {
+        unsigned int head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail)
+                return false;
+        }
+        item = mItems[head & mMask];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    inline unsigned int GetCapacity() const { return mCapacity; }
+    inline unsigned int GetDroppedCount() const { return mDroppedCount.load(std::memory_order_relaxed); }
+private:
+    SampleRing(const SampleRing &);
+    SampleRing &operator = (const SampleRing &);
+
+    enum { CACHE_LINE_SIZE = 64 };
+
+    Item *mItems;
+    unsigned int mCapacity;
+    unsigned int mMask;
+    char mPad0[CACHE_LINE_SIZE];
+
+    // written by the producer
+    std::atomic<unsigned int> mTail;
+    unsigned int mCachedHead;
+    std::atomic<unsigned int> mDroppedCount;
+    char mPad1[CACHE_LINE_SIZE];
+
+    // written by the consumer
+    std::atomic<unsigned int> mHead;
+    unsigned int mCachedTail;
+    char mPad2[CACHE_LINE_SIZE];
+};
+
+typedef SampleRing<TouchSample> TouchSampleRing;
+
+#endif
@@ -0,0 +1,160 @@
+#include "input/TouchSlotMap.h"
+#include "input/GestureMemory.h"
+
+//-------------------------------------------------- TouchSlotMap -------------------------------------------------
+TouchSlotMap::TouchSlotMap(unsigned int slotCount) : mSlotCount(slotCount), mPressedCount(0)
+{
+    assert(mSlotCount >= 1 && mSlotCount < 0x40000000u);
+    // load factor <= 1/2
+    unsigned int bucketCount = 16;
+    mHashShift = 28;
+    while (bucketCount < mSlotCount * 2)
+    {
+        bucketCount <<= 1;
+        mHashShift --;
+    }
+    mBucketMask = bucketCount - 1;
+    mBucketIds = (unsigned int *)GestureMemory::Allocate(sizeof(unsigned int) * bucketCount);
+    mBucketSlots = (unsigned int *)GestureMemory::Allocate(sizeof(unsigned int) * bucketCount);
+
+    mSlotIds = (unsigned int *)GestureMemory::Allocate(sizeof(unsigned int) * mSlotCount);
+    mSlotMapped = (bool *)GestureMemory::Allocate(sizeof(bool) * mSlotCount);
+    mSlotPressed = (bool *)GestureMemory::Allocate(sizeof(bool) * mSlotCount);
+    mPrevReleased = (unsigned int *)GestureMemory::Allocate(sizeof(unsigned int) * mSlotCount);
+    mNextReleased = (unsigned int *)GestureMemory::Allocate(sizeof(unsigned int) * mSlotCount);
+    Reset();
+}
+
+TouchSlotMap::~TouchSlotMap()
+{
+    GestureMemory::Free(mBucketIds);
+    GestureMemory::Free(mBucketSlots);
+    GestureMemory::Free(mSlotIds);
+    GestureMemory::Free(mSlotMapped);
+    GestureMemory::Free(mSlotPressed);
+    GestureMemory::Free(mPrevReleased);
+    GestureMemory::Free(mNextReleased);
+}
+
+void TouchSlotMap::Reset()
+{
+    for (unsigned int i=0; i<=mBucketMask; i++)
+        mBucketSlots[i] = INVALID_SLOT;
+    mOldestReleased = mNewestReleased = INVALID_SLOT;
+    mPressedCount = 0;
+    for (unsigned int i=0; i<mSlotCount; i++)
+    {
+        mSlotIds[i] = 0;
+        mSlotMapped[i] = false;
+        mSlotPressed[i] = false;
+        LinkReleased(i);
+    }
+}
+
+unsigned int TouchSlotMap::Press(unsigned int id)
+{
+    unsigned int slot = Find(id);
+    if (slot != INVALID_SLOT)
+    {
+        if (!mSlotPressed[slot])
+        {
+            UnlinkReleased(slot);
+            mSlotPressed[slot] = true;
+            mPressedCount ++;
+        }
+        return slot;
+    }
+    // claim the slot released the longest ago
+    slot = mOldestReleased;
+    if (slot == INVALID_SLOT)
+        return INVALID_SLOT;
+    UnlinkReleased(slot);
+    if (mSlotMapped[slot])
+        Erase(mSlotIds[slot]);
+    Insert(id, slot);
+    mSlotIds[slot] = id;
+    mSlotMapped[slot] = true;
+    mSlotPressed[slot] = true;
+    mPressedCount ++;
+    return slot;
+}
+
+unsigned int TouchSlotMap::Find(unsigned int id) const
+{
+    unsigned int bucket = FindBucket(id);
+    return mBucketSlots[bucket];
+}
+
+void TouchSlotMap::Release(unsigned int slot)
+{
+    assert(slot < mSlotCount);
+    if (!mSlotPressed[slot])
+        return;
+    mSlotPressed[slot] = false;
+    mPressedCount --;
+    LinkReleased(slot);
+}
+
+unsigned int TouchSlotMap::FindBucket(unsigned int id) const
+{
+    // the bucket holding id, or the empty bucket ending its probe sequence
+    unsigned int bucket = Hash(id);
+    while ((mBucketSlots[bucket] != INVALID_SLOT) && (mBucketIds[bucket] != id))
+        bucket = (bucket + 1) & mBucketMask;
+    return bucket;
+}
+
+void TouchSlotMap::Insert(unsigned int id, unsigned int slot)
+{
+    unsigned int bucket = FindBucket(id);
+    mBucketIds[bucket] = id;
+    mBucketSlots[bucket] = slot;
+}
+
+void TouchSlotMap::Erase(unsigned int id)
+{
+    unsigned int hole = FindBucket(id);
+    if (mBucketSlots[hole] == INVALID_SLOT)
+        return;
+    // backward shift: move up every following entry whose home bucket is not in (hole, bucket]
+    unsigned int bucket = hole;
+    for (;;)
+    {
+        bucket = (bucket + 1) & mBucketMask;
+        if (mBucketSlots[bucket] == INVALID_SLOT)
+            break;
+        unsigned int home = Hash(mBucketIds[bucket]);
+        bool between = (hole <= bucket) ? ((hole < home) && (home <= bucket)) : ((hole < home) || (home <= bucket));
+        if (between)
+            continue;
+        mBucketIds[hole] = mBucketIds[bucket];
+        mBucketSlots[hole] = mBucketSlots[bucket];
+        hole = bucket;
+    }
+    mBucketSlots[hole] = INVALID_SLOT;
+}
+
+void TouchSlotMap::LinkReleased(unsigned int slot)
+{
+    mPrevReleased[slot] = mNewestReleased;
+    mNextReleased[slot] = INVALID_SLOT;
+    if (mNewestReleased != INVALID_SLOT)
+        mNextReleased[mNewestReleased] = slot;
+    else
+        mOldestReleased = slot;
+    mNewestReleased = slot;
+}
+
+void TouchSlotMap::UnlinkReleased(unsigned int slot)
+{
+    unsigned int prev = mPrevReleased[slot];
+    unsigned int next = mNextReleased[slot];
+    if (prev != INVALID_SLOT)
+        mNextReleased[prev] = next;
+    else
+        mOldestReleased = next;
+    if (next != INVALID_SLOT)
+        mPrevReleased[next] = prev;
+    else
+        mNewestReleased = prev;
+}
@@ -0,0 +1,64 @@
+#ifndef TOUCH_SLOT_MAP_H_
+#define TOUCH_SLOT_MAP_H_
+
+#include "input/GesturePlatform.h"
+
+//---------------------------- pointer id to dense touch slot ----------------------------
+// the platforms report sparse pointer ids (large, reused or not), the touch tracks and the recognizer state live in
+// dense slots [0, slotCount). open addressing hash (linear probing, backward shift deletion) from id to slot,
+// every operation is O(1) and nothing is allocated after construction
+// a released slot stays mapped to its id, so a quick second press of the same id finds its old track (double tap),
+// until a new id claims the slot, the slot released the longest ago is claimed first
+class TouchSlotMap
+{
+public:
+    enum { INVALID_SLOT = 0xffffffff };
+
+    TouchSlotMap(unsigned int slotCount);
+    ~TouchSlotMap();
+
+    // slot of a pressed id, INVALID_SLOT when every slot is held by a pressed id
+    unsigned int Press(unsigned int id);
+    // slot the id is mapped to, INVALID_SLOT if there is none
+    unsigned int Find(unsigned int id) const;
+    // the slot becomes claimable, it keeps its id until then
+    void Release(unsigned int slot);
+
+    // every id unmapped, as constructed
+    void Reset();
+
+    inline unsigned int GetSlotCount() const { return mSlotCount; }
+    inline unsigned int GetPressedCount() const { return mPressedCount; }
+private:
+    TouchSlotMap(const TouchSlotMap &);
+    TouchSlotMap &operator = (const TouchSlotMap &);
+
+    inline unsigned int Hash(unsigned int id) const { return (id * 0x9e3779b1u) >> mHashShift; }
+    unsigned int FindBucket(unsigned int id) const;
+    void Insert(unsigned int id, unsigned int slot);
+    void Erase(unsigned int id);
+
+    void LinkReleased(unsigned int slot);
+    void UnlinkReleased(unsigned int slot);
+
+    // hash table, mBucketSlots[i] == INVALID_SLOT marks an empty bucket
+    unsigned int *mBucketIds;
+    unsigned int *mBucketSlots;
+    unsigned int mBucketMask;
+    unsigned int mHashShift;
+
+    // per slot
+    unsigned int *mSlotIds;
+    bool *mSlotMapped;
+    bool *mSlotPressed;
+    // released slots, the oldest first
+    unsigned int *mPrevReleased;
+    unsigned int *mNextReleased;
+    unsigned int mOldestReleased;
+    unsigned int mNewestReleased;
+
+    unsigned int mSlotCount;
+    unsigned int mPressedCount;
+};
+
+#endif
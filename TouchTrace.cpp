@@ -0,0 +1,270 @@
+#include "input/TouchTrace.h"
+#include "input/TouchManager.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static inline void _WriteU16(unsigned char *p, unsigned int v)
+{
+    p[0] = (unsigned char)(v & 0xff);
+    p[1] = (unsigned char)((v >> 8) & 0xff);
+}
+
+static inline void _WriteU32(unsigned char *p, unsigned int v)
+{
+    _WriteU16(p, v & 0xffff);
+    _WriteU16(p + 2, v >> 16);
+}
+
+static inline unsigned int _ReadU16(const unsigned char *p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+static inline unsigned int _ReadU32(const unsigned char *p)
+{
+    return _ReadU16(p) | (_ReadU16(p + 2) << 16);
+}
+
+static inline int _ClampS16(int v)
+{
+    if (v < -32768)
+        return -32768;
+    if (v > 32767)
+        return 32767;
+    return v;
+}
+
+//---------------------------------------------- TouchTraceRecorder -----------------------------------------------
+TouchTraceRecorder::TouchTraceRecorder() : mFile(0), mRecordCount(0), mBufferUsed(0)
+{
+}
+
+TouchTraceRecorder::~TouchTraceRecorder()
+{
+    Close();
+}
+
+bool TouchTraceRecorder::Open(const char *path, unsigned int viewportWidth, unsigned int viewportHeight)
+{
+    Close();
+    mFile = fopen(path, "wb");
+    if (!mFile)
+        return false;
+    unsigned char header[TOUCH_TRACE_HEADER_SIZE];
+    _WriteU32(header, TOUCH_TRACE_MAGIC);
+    _WriteU16(header + 4, TOUCH_TRACE_VERSION);
+    _WriteU16(header + 6, TOUCH_TRACE_HEADER_SIZE);
+    _WriteU32(header + 8, viewportWidth);
+    _WriteU32(header + 12, viewportHeight);
+    if (fwrite(header, 1, TOUCH_TRACE_HEADER_SIZE, mFile) != TOUCH_TRACE_HEADER_SIZE)
+    {
+        fclose(mFile);
+        mFile = 0;
+        return false;
+    }
+    mRecordCount = 0;
+    mBufferUsed = 0;
+    return true;
+}
+
+void TouchTraceRecorder::Close()
+{
+    if (!mFile)
+        return;
+    Flush();
+    fclose(mFile);
+    mFile = 0;
+}
+
+void TouchTraceRecorder::Record(__u8 type, int x, int y, unsigned int touchIndex, HexTime time)
+{
+    if (!mFile)
+        return;
+    if (mBufferUsed + TOUCH_TRACE_RECORD_SIZE > sizeof(mBuffer))
+        Flush();
+    unsigned char *p = mBuffer + mBufferUsed;
+    _WriteU32(p, (unsigned int)time);
+    _WriteU16(p + 4, (unsigned int)_ClampS16(x) & 0xffff);
+    _WriteU16(p + 6, (unsigned int)_ClampS16(y) & 0xffff);
+    _WriteU16(p + 8, touchIndex > 0xffff ? 0xffff : touchIndex);
+    p[10] = type;
+    p[11] = 0;
+    mBufferUsed += TOUCH_TRACE_RECORD_SIZE;
+    mRecordCount ++;
+}
+
+void TouchTraceRecorder::Flush()
+{
+    if (!mFile || !mBufferUsed)
+        return;
+    fwrite(mBuffer, 1, mBufferUsed, mFile);
+    fflush(mFile);
+    mBufferUsed = 0;
+}
+
+//----------------------------------------------- TouchTraceReader ------------------------------------------------
+TouchTraceReader::TouchTraceReader() : mData(0), mSize(0), mRecords(0), mRecordCount(0), mVersion(0), mViewportWidth(0), mViewportHeight(0),
+        mMapping(0), mMappingSize(0)
+{
+}
+
+TouchTraceReader::~TouchTraceReader()
+{
+    Close();
+}
+
+bool TouchTraceReader::Open(const char *path)
+{
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    DWORD size = GetFileSize(file, 0);
+    HANDLE mapping = (size > 0) ? CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0) : 0;
+    void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+    // the view keeps the mapping alive
+    if (mapping)
+        CloseHandle(mapping);
+    CloseHandle(file);
+    if (!view)
+        return false;
+    mMapping = view;
+    mMappingSize = (unsigned int)size;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size <= 0))
+    {
+        close(fd);
+        return false;
+    }
+    void *view = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+    madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+    mMapping = view;
+    mMappingSize = (unsigned int)st.st_size;
+#endif
+    mData = (const unsigned char *)mMapping;
+    mSize = mMappingSize;
+    if (!ParseHeader())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool TouchTraceReader::OpenMemory(const void *data, unsigned int size)
+{
+    Close();
+    mData = (const unsigned char *)data;
+    mSize = size;
+    if (!ParseHeader())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void TouchTraceReader::Close()
+{
+    if (mMapping)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mMapping);
+#else
+        munmap(mMapping, mMappingSize);
+#endif
+    }
+    mMapping = 0;
+    mMappingSize = 0;
+    mData = 0;
+    mSize = 0;
+    mRecords = 0;
+    mRecordCount = 0;
+    mVersion = 0;
+    mViewportWidth = mViewportHeight = 0;
+}
+
+bool TouchTraceReader::ParseHeader()
+{
+    if (!mData || (mSize < TOUCH_TRACE_HEADER_SIZE))
+        return false;
+    if (_ReadU32(mData) != TOUCH_TRACE_MAGIC)
+        return false;
+    mVersion = _ReadU16(mData + 4);
+    unsigned int headerSize = _ReadU16(mData + 6);
+    if ((mVersion != TOUCH_TRACE_VERSION) || (headerSize < TOUCH_TRACE_HEADER_SIZE) || (headerSize > mSize))
+        return false;
+    mViewportWidth = _ReadU32(mData + 8);
+    mViewportHeight = _ReadU32(mData + 12);
+    mRecords = mData + headerSize;
+    // a truncated tail record (crash while recording) is ignored
+    mRecordCount = (mSize - headerSize) / TOUCH_TRACE_RECORD_SIZE;
+    return true;
+}
+
+HexTime TouchTraceReader::GetDuration() const
+{
+    if (mRecordCount < 2)
+        return 0;
+    return (HexTime)(_ReadU32(mRecords + (mRecordCount - 1) * TOUCH_TRACE_RECORD_SIZE) - _ReadU32(mRecords));
+}
+
+bool TouchTraceReader::GetRecord(unsigned int index, TouchTraceRecord &record) const
+{
+    if (index >= mRecordCount)
+        return false;
+    const unsigned char *p = mRecords + index * TOUCH_TRACE_RECORD_SIZE;
+    record.time = (HexTime)_ReadU32(p);
+    record.x = (short)_ReadU16(p + 4);
+    record.y = (short)_ReadU16(p + 6);
+    record.touchIndex = _ReadU16(p + 8);
+    record.type = p[10];
+    return true;
+}
+
+unsigned int TouchTraceReader::Replay(TouchManager *manager) const
+{
+    GestureClock &clock = manager->GetClock();
+    TouchTraceRecord record;
+    for (unsigned int i=0; i<mRecordCount; i++)
+    {
+        GetRecord(i, record);
+        clock.SetManualTime(record.time);
+        switch (record.type)
+        {
+            case TouchTraceRecord::TRACE_PRESS:
+                manager->AddTouch(record.x, record.y, record.touchIndex);
+                break;
+            case TouchTraceRecord::TRACE_MOVE:
+                manager->TouchMove(record.x, record.y, record.touchIndex);
+                break;
+            case TouchTraceRecord::TRACE_RELEASE:
+                manager->ReleaseTouch(record.x, record.y, record.touchIndex);
+                break;
+            case TouchTraceRecord::TRACE_UPDATE:
+                //the input thread wakes up with the frame
+                if (manager->IsInputTimeRecognition())
+                    manager->Poll();
+                manager->Update();
+                break;
+            default:
+                break;
+        }
+    }
+    return mRecordCount;
+}
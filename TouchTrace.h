@@ -0,0 +1,101 @@
+#ifndef TOUCH_TRACE_H_
+#define TOUCH_TRACE_H_
+
+#include "input/GesturePlatform.h"
+#include <stdio.h>
+
+class TouchManager;
+
+// binary touch trace, little-endian:
+//   header  : "GTRC" | u16 version | u16 header size | u32 viewport width | u32 viewport height
+//   records : u32 time | s16 x | s16 y | u16 touch index | u8 type | u8 reserved     (12 bytes each)
+#define TOUCH_TRACE_MAGIC           0x43525447      // "GTRC"
+#define TOUCH_TRACE_VERSION         1
+#define TOUCH_TRACE_HEADER_SIZE     16
+#define TOUCH_TRACE_RECORD_SIZE     12
+
+struct TouchTraceRecord
+{
+    enum RecordType
+    {
+        TRACE_NONE      = 0,
+        TRACE_PRESS     = 1,
+        TRACE_MOVE      = 2,
+        TRACE_RELEASE   = 3,
+        TRACE_UPDATE    = 4,
+    };
+
+    TouchTraceRecord() : time(0), x(0), y(0), touchIndex(0), type(TRACE_NONE) {}
+
+    HexTime time;
+    int x;
+    int y;
+    unsigned int touchIndex;
+    __u8 type;
+};
+
+//---------------------------- recorder ----------------------------
+class TouchTraceRecorder
+{
+public:
+    TouchTraceRecorder();
+    virtual ~TouchTraceRecorder();
+
+    bool Open(const char *path, unsigned int viewportWidth, unsigned int viewportHeight);
+    void Close();
+    inline bool IsOpen() const { return mFile != 0; }
+
+    void Record(__u8 type, int x, int y, unsigned int touchIndex, HexTime time);
+    void Flush();
+
+    inline unsigned int GetRecordCount() const { return mRecordCount; }
+private:
+    enum { BUFFER_RECORD_COUNT = 1024 };
+
+    FILE *mFile;
+    unsigned int mRecordCount;
+    unsigned int mBufferUsed;
+    unsigned char mBuffer[BUFFER_RECORD_COUNT * TOUCH_TRACE_RECORD_SIZE];
+};
+
+//---------------------------- reader ----------------------------
+// the file is memory mapped, records are decoded in place while replaying
+class TouchTraceReader
+{
+public:
+    TouchTraceReader();
+    virtual ~TouchTraceReader();
+
+    bool Open(const char *path);
+    // read a trace already in memory, the buffer must outlive the reader
+    bool OpenMemory(const void *data, unsigned int size);
+    void Close();
+    inline bool IsOpen() const { return mData != 0; }
+
+    inline unsigned int GetVersion() const { return mVersion; }
+    inline unsigned int GetViewportWidth() const { return mViewportWidth; }
+    inline unsigned int GetViewportHeight() const { return mViewportHeight; }
+    inline unsigned int GetRecordCount() const { return mRecordCount; }
+    HexTime GetDuration() const;
+
+    bool GetRecord(unsigned int index, TouchTraceRecord &record) const;
+
+    // feed every record through the manager entry points as fast as possible, the manager clock is switched to manual time
+    // returns the number of records replayed
+    unsigned int Replay(TouchManager *manager) const;
+private:
+    bool ParseHeader();
+
+    const unsigned char *mData;
+    unsigned int mSize;
+    const unsigned char *mRecords;
+    unsigned int mRecordCount;
+    unsigned int mVersion;
+    unsigned int mViewportWidth;
+    unsigned int mViewportHeight;
+
+    void *mMapping;
+    unsigned int mMappingSize;
+};
+
+#endif
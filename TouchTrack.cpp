@@ -0,0 +1,173 @@
+#include "input/TouchTrack.h"
+#include "input/GestureMemory.h"
+#include "input/TouchTrackArena.h"
+
+//--------------------------------------------------- TouchTrack --------------------------------------------------
+TouchTrack::TouchTrack() : mX(0), mY(0), mTime(0), mSize(0), mCapacity(0), mFixed(false), mArena(0)
+{
+}
+
+TouchTrack::TouchTrack(float *x, float *y, HexTime *time, unsigned int capacity) : mX(x), mY(y), mTime(time), mSize(0), mCapacity(capacity),
+        mFixed(true), mArena(0)
+{
+}
+
+TouchTrack::~TouchTrack()
+{
+    FreeStorage();
+}
+
+void TouchTrack::FreeStorage()
+{
+    if (mFixed)
+        return;
+    if (mArena && mX && mArena->Owns(mX))
+        mArena->Release(mX, mCapacity / TouchTrackArena::CHUNK_POINTS);
+    else
+        GestureMemory::Free(mX);
+    mX = mY = 0;
+    mTime = 0;
+    mCapacity = 0;
+}
+
+void TouchTrack::ClearAndRelease()
+{
+    mSize = 0;
+    FreeStorage();
+}
+
+void TouchTrack::SetArena(TouchTrackArena *arena)
+{
+    assert(!mFixed);
+    unsigned int capacity = mCapacity;
+    ClearAndRelease();
+    mArena = arena;
+    if (capacity)
+        Reserve(capacity);
+}
+
+void TouchTrack::ClearAndForceAllocation(unsigned int capacity)
+{
+    mSize = 0;
+    if (mFixed)
+    {
+        assert(capacity <= mCapacity);
+        return;
+    }
+    if (capacity != mCapacity)
+    {
+        FreeStorage();
+        Reserve(capacity);
+    }
+}
+
+void TouchTrack::Reserve(unsigned int capacity)
+{
+    //an arena run is whole chunks
+    unsigned int alignment = mArena ? (unsigned int)TouchTrackArena::CHUNK_POINTS : (unsigned int)TRACK_CAPACITY_ALIGNMENT;
+    capacity = (capacity + alignment - 1) & ~(alignment - 1);
+    if (capacity <= mCapacity)
+        return;
+    //the owner of a fixed storage bounds the track (see TouchQueue::SetTrackMemoryBudget)
+    assert(!mFixed);
+    unsigned char *block = 0;
+    if (mArena)
+    {
+        block = (unsigned char *)mArena->Allocate(capacity / TouchTrackArena::CHUNK_POINTS);
+        if (!block)
+            mArena->CountOverflow();
+    }
+    if (!block)
+        block = (unsigned char *)GestureMemory::Allocate(TRACK_POINT_SIZE * capacity);
+    assert(block);
+    float *x = (float *)block;
+    float *y = x + capacity;
+    HexTime *time = (HexTime *)(y + capacity);
+    if (mSize)
+    {
+        memcpy(x, mX, sizeof(float) * mSize);
+        memcpy(y, mY, sizeof(float) * mSize);
+        memcpy(time, mTime, sizeof(HexTime) * mSize);
+    }
+    FreeStorage();
+    mX = x;
+    mY = y;
+    mTime = time;
+    mCapacity = capacity;
+}
+
+void TouchTrack::Push(float x, float y, HexTime time)
+{
+    if (mSize == mCapacity)
+        Reserve(mCapacity ? mCapacity * 2 : 32);
+    mX[mSize] = x;
+    mY[mSize] = y;
+    mTime[mSize] = time;
+    mSize ++;
+}
+
+unsigned int TouchTrack::RemoveGap(unsigned int writeIndex, unsigned int last)
+{
+    unsigned int removed = last - writeIndex;
+    if (!removed)
+        return 0;
+    unsigned int tail = mSize - last;
+    memmove(mX + writeIndex, mX + last, sizeof(float) * tail);
+    memmove(mY + writeIndex, mY + last, sizeof(float) * tail);
+    memmove(mTime + writeIndex, mTime + last, sizeof(HexTime) * tail);
+    mSize -= removed;
+    return removed;
+}
+
+unsigned int TouchTrack::SimplifyRange(unsigned int first, unsigned int last, float tolerance)
+{
+    if (first == 0)
+        first = 1;
+    if (last > mSize)
+        last = mSize;
+    if (first >= last)
+        return 0;
+    float toleranceSqr = tolerance * tolerance;
+    float refX = mX[first - 1];
+    float refY = mY[first - 1];
+    unsigned int w = first;
+    for (unsigned int i=first; i<last; i++)
+    {
+        float dx = mX[i] - refX;
+        float dy = mY[i] - refY;
+        if (dx * dx + dy * dy < toleranceSqr)
+            continue;
+        refX = mX[i];
+        refY = mY[i];
+        mX[w] = mX[i];
+        mY[w] = mY[i];
+        mTime[w] = mTime[i];
+        w ++;
+    }
+    return RemoveGap(w, last);
+}
+
+unsigned int TouchTrack::DecimateRange(unsigned int first, unsigned int last)
+{
+    if (last > mSize)
+        last = mSize;
+    if (first >= last)
+        return 0;
+    // keep the second of every pair, so the point right before 'last' survives
+    unsigned int w = first;
+    for (unsigned int i=first + 1; i<last; i+=2)
+    {
+        mX[w] = mX[i];
+        mY[w] = mY[i];
+        mTime[w] = mTime[i];
+        w ++;
+    }
+    if ((last - first) & 1)
+    {
+        mX[w] = mX[last - 1];
+        mY[w] = mY[last - 1];
+        mTime[w] = mTime[last - 1];
+        w ++;
+    }
+    return RemoveGap(w, last);
+}
@@ -0,0 +1,86 @@
+#ifndef TOUCH_TRACK_H_
+#define TOUCH_TRACK_H_
+
+#include "input/GesturePlatform.h"
+
+class TouchTrackArena;
+
+struct TouchPoint
+{
+    TouchPoint() : point(FastMath::Vector2::Zero()), time(0) {}
+    TouchPoint(const FastMath::Vector2 &p, HexTime t) : point(p), time(t) {}
+
+    inline bool IsValid() { return time != 0; }
+
+    FastMath::Vector2 point;
+    HexTime time;
+};
+
+//---------------------------- class for touch track storage ----------------------------
+// structure of arrays: contiguous x[], y[] and time[], so the track kernels can stream them
+// the three arrays share one block, the capacity is kept a multiple of TRACK_CAPACITY_ALIGNMENT
+class TouchTrack
+{
+public:
+    enum
+    {
+        TRACK_CAPACITY_ALIGNMENT    = 8,
+        TRACK_POINT_SIZE            = sizeof(float) * 2 + sizeof(HexTime),
+    };
+
+    TouchTrack();
+    // fixed storage of capacity points (not owned), the track never grows beyond it
+    TouchTrack(float *x, float *y, HexTime *time, unsigned int capacity);
+    ~TouchTrack();
+
+    void Push(float x, float y, HexTime time);
+    inline void Push(const TouchPoint &p) { Push(p.point.x(), p.point.y(), p.time); }
+
+    // keeps the memory
+    inline void Clear() { mSize = 0; }
+    void ClearAndForceAllocation(unsigned int capacity);
+    // gives the memory back, the next Push allocates again
+    void ClearAndRelease();
+
+    // the storage comes from the arena from now on (0: the heap), the track must not be fixed
+    void SetArena(TouchTrackArena *arena);
+    inline TouchTrackArena *GetArena() const { return mArena; }
+
+    inline unsigned int Size() const { return mSize; }
+    inline bool IsEmpty() const { return mSize == 0; }
+    inline unsigned int GetCapacity() const { return mCapacity; }
+    inline bool IsFixed() const { return mFixed; }
+
+    inline float X(unsigned int index) const { assert(index < mSize); return mX[index]; }
+    inline float Y(unsigned int index) const { assert(index < mSize); return mY[index]; }
+    inline HexTime Time(unsigned int index) const { assert(index < mSize); return mTime[index]; }
+    inline TouchPoint operator [] (unsigned int index) const { return TouchPoint(FastMath::Vector2(X(index), Y(index)), Time(index)); }
+
+    inline const float *GetX() const { return mX; }
+    inline const float *GetY() const { return mY; }
+    inline const HexTime *GetTime() const { return mTime; }
+
+    // in place simplification of the points [first, last), the points from last on move down
+    // both return the number of removed points
+    // radial distance: drops every point closer than tolerance to the previous kept one (the point first - 1 is the first reference)
+    unsigned int SimplifyRange(unsigned int first, unsigned int last, float tolerance);
+    // drops every second point
+    unsigned int DecimateRange(unsigned int first, unsigned int last);
+private:
+    TouchTrack(const TouchTrack &);
+    TouchTrack &operator = (const TouchTrack &);
+
+    void Reserve(unsigned int capacity);
+    void FreeStorage();
+    unsigned int RemoveGap(unsigned int writeIndex, unsigned int last);
+
+    float *mX;
+    float *mY;
+    HexTime *mTime;
+    unsigned int mSize;
+    unsigned int mCapacity;
+    bool mFixed;
+    TouchTrackArena *mArena;
+};
+
+#endif
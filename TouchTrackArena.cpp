@@ -0,0 +1,60 @@
+#include "input/TouchTrackArena.h"
+#include "input/GestureMemory.h"
+
+//------------------------------------------------ TouchTrackArena ------------------------------------------------
+TouchTrackArena::TouchTrackArena(unsigned int chunkCount) : mBlock(0), mChunkUsed(0), mChunkCount(chunkCount), mUsedChunkCount(0),
+        mFirstFree(0), mOverflowCount(0)
+{
+    assert(mChunkCount >= 1);
+    mBlock = (unsigned char *)GestureMemory::Allocate(mChunkCount * CHUNK_SIZE);
+    mChunkUsed = (unsigned char *)GestureMemory::AllocateZeroed(mChunkCount, 1);
+    assert(mBlock && mChunkUsed);
+}
+
+TouchTrackArena::~TouchTrackArena()
+{
+    //every track must have given its run back
+    assert(mUsedChunkCount == 0);
+    GestureMemory::Free(mChunkUsed);
+    GestureMemory::Free(mBlock);
+}
+
+void *TouchTrackArena::Allocate(unsigned int chunkCount)
+{
+    assert(chunkCount >= 1);
+    if (mUsedChunkCount + chunkCount > mChunkCount)
+        return 0;
+    unsigned int runStart = mFirstFree;
+    unsigned int runLength = 0;
+    for (unsigned int i=mFirstFree; i<mChunkCount; i++)
+    {
+        if (mChunkUsed[i])
+        {
+            runStart = i + 1;
+            runLength = 0;
+            continue;
+        }
+        if (++runLength < chunkCount)
+            continue;
+        memset(mChunkUsed + runStart, 1, chunkCount);
+        mUsedChunkCount += chunkCount;
+        if (runStart == mFirstFree)
+        {
+            while ((mFirstFree < mChunkCount) && mChunkUsed[mFirstFree])
+                mFirstFree ++;
+        }
+        return mBlock + runStart * CHUNK_SIZE;
+    }
+    return 0;
+}
+
+void TouchTrackArena::Release(void *block, unsigned int chunkCount)
+{
+    assert(Owns(block));
+    unsigned int first = (unsigned int)(((unsigned char *)block - mBlock) / CHUNK_SIZE);
+    assert(first + chunkCount <= mChunkCount);
+    memset(mChunkUsed + first, 0, chunkCount);
+    mUsedChunkCount -= chunkCount;
+    if (first < mFirstFree)
+        mFirstFree = first;
+}
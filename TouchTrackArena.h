@@ -0,0 +1,51 @@
+#ifndef TOUCH_TRACK_ARENA_H_
+#define TOUCH_TRACK_ARENA_H_
+
+#include "input/TouchTrack.h"
+
+//---------------------------- arena of the touch track storage ----------------------------
+// one block preallocated at construction, cut into chunks of CHUNK_POINTS points
+// a growing track takes a run of contiguous chunks for its x[], y[] and time[] arrays and gives the old run back,
+// the run of a track goes back to the arena once its contact is released and no recognizer tracks it any more
+// so the tracks of a TouchManager stay in one place over a long session, without heap traffic nor fragmentation
+// a run the arena can not find is taken from the heap instead and counted (GetOverflowCount)
+// not thread safe, the tracks belong to the thread that recognizes
+class TouchTrackArena
+{
+public:
+    enum
+    {
+        CHUNK_POINTS    = 32,
+        CHUNK_SIZE      = CHUNK_POINTS * TouchTrack::TRACK_POINT_SIZE,
+    };
+
+    TouchTrackArena(unsigned int chunkCount);
+    ~TouchTrackArena();
+
+    // first fit run of chunkCount contiguous chunks, 0 if there is none
+    void *Allocate(unsigned int chunkCount);
+    void Release(void *block, unsigned int chunkCount);
+    inline bool Owns(const void *block) const
+    {
+        return ((const unsigned char *)block >= mBlock) && ((const unsigned char *)block < mBlock + mChunkCount * CHUNK_SIZE);
+    }
+    inline void CountOverflow() { mOverflowCount ++; }
+
+    inline unsigned int GetChunkCount() const { return mChunkCount; }
+    inline unsigned int GetUsedChunkCount() const { return mUsedChunkCount; }
+    // runs taken from the heap because the arena was full
+    inline unsigned int GetOverflowCount() const { return mOverflowCount; }
+private:
+    TouchTrackArena(const TouchTrackArena &);
+    TouchTrackArena &operator = (const TouchTrackArena &);
+
+    unsigned char *mBlock;
+    unsigned char *mChunkUsed;
+    unsigned int mChunkCount;
+    unsigned int mUsedChunkCount;
+    // no free chunk below it
+    unsigned int mFirstFree;
+    unsigned int mOverflowCount;
+};
+
+#endif
@@ -0,0 +1,502 @@
+#include "input/TouchTrackKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define _TRACK_KERNELS_AVX2_
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define _TRACK_KERNELS_SSE2_
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _TRACK_KERNELS_NEON_
+#endif
+
+#if defined(_TRACK_KERNELS_AVX2_) || defined(_TRACK_KERNELS_SSE2_) || defined(_TRACK_KERNELS_NEON_)
+#define _TRACK_KERNELS_SIMD_
+#endif
+
+//---------------------------- lane operations ----------------------------
+// every kernel is written once against these, VMask lanes are all-ones where the condition holds
+#if defined(_TRACK_KERNELS_AVX2_)
+#define _LANES_ 8
+typedef __m256 VFloat;
+typedef __m256 VMask;
+static inline VFloat VLoad(const float *p) { return _mm256_loadu_ps(p); }
+static inline VFloat VSet(float v) { return _mm256_set1_ps(v); }
+static inline VFloat VAdd(VFloat a, VFloat b) { return _mm256_add_ps(a, b); }
+static inline VFloat VSub(VFloat a, VFloat b) { return _mm256_sub_ps(a, b); }
+static inline VFloat VMul(VFloat a, VFloat b) { return _mm256_mul_ps(a, b); }
+static inline VFloat VDiv(VFloat a, VFloat b) { return _mm256_div_ps(a, b); }
+static inline VFloat VSqrt(VFloat a) { return _mm256_sqrt_ps(a); }
+static inline VFloat VMax(VFloat a, VFloat b) { return _mm256_max_ps(a, b); }
+static inline VFloat VMin(VFloat a, VFloat b) { return _mm256_min_ps(a, b); }
+static inline VFloat VAbs(VFloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline VFloat VAnd(VFloat a, VMask m) { return _mm256_and_ps(a, m); }
+static inline VMask VGreater(VFloat a, VFloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline VFloat VSelect(VMask m, VFloat a, VFloat b) { return _mm256_blendv_ps(b, a, m); }
+static inline VFloat VLaneIndex() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+static inline VMask VNone() { return _mm256_setzero_ps(); }
+static inline VMask VOr(VMask a, VMask b) { return _mm256_or_ps(a, b); }
+static inline bool VAny(VMask m) { return _mm256_movemask_ps(m) != 0; }
+// (float)(int)(t[i] - t[i - 1]) and the mask of the non-zero deltas
+static inline VFloat VTimeDelta(const HexTime *t, VMask &nonZero)
+{
+    __m256i dt = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)t), _mm256_loadu_si256((const __m256i *)(t - 1)));
+    nonZero = _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(dt, _mm256_setzero_si256()), _mm256_set1_epi32(-1)));
+    return _mm256_cvtepi32_ps(dt);
+}
+static inline void VStore(float *p, VFloat a) { _mm256_storeu_ps(p, a); }
+#elif defined(_TRACK_KERNELS_SSE2_)
+#define _LANES_ 4
+typedef __m128 VFloat;
+typedef __m128 VMask;
+static inline VFloat VLoad(const float *p) { return _mm_loadu_ps(p); }
+static inline VFloat VSet(float v) { return _mm_set1_ps(v); }
+static inline VFloat VAdd(VFloat a, VFloat b) { return _mm_add_ps(a, b); }
+static inline VFloat VSub(VFloat a, VFloat b) { return _mm_sub_ps(a, b); }
+static inline VFloat VMul(VFloat a, VFloat b) { return _mm_mul_ps(a, b); }
+static inline VFloat VDiv(VFloat a, VFloat b) { return _mm_div_ps(a, b); }
+static inline VFloat VSqrt(VFloat a) { return _mm_sqrt_ps(a); }
+static inline VFloat VMax(VFloat a, VFloat b) { return _mm_max_ps(a, b); }
+static inline VFloat VMin(VFloat a, VFloat b) { return _mm_min_ps(a, b); }
+static inline VFloat VAbs(VFloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline VFloat VAnd(VFloat a, VMask m) { return _mm_and_ps(a, m); }
+static inline VMask VGreater(VFloat a, VFloat b) { return _mm_cmpgt_ps(a, b); }
+static inline VFloat VSelect(VMask m, VFloat a, VFloat b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline VFloat VLaneIndex() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+static inline VMask VNone() { return _mm_setzero_ps(); }
+static inline VMask VOr(VMask a, VMask b) { return _mm_or_ps(a, b); }
+static inline bool VAny(VMask m) { return _mm_movemask_ps(m) != 0; }
+static inline VFloat VTimeDelta(const HexTime *t, VMask &nonZero)
+{
+    __m128i dt = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)t), _mm_loadu_si128((const __m128i *)(t - 1)));
+    nonZero = _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(dt, _mm_setzero_si128()), _mm_set1_epi32(-1)));
+    return _mm_cvtepi32_ps(dt);
+}
+static inline void VStore(float *p, VFloat a) { _mm_storeu_ps(p, a); }
+#elif defined(_TRACK_KERNELS_NEON_)
+#define _LANES_ 4
+typedef float32x4_t VFloat;
+typedef uint32x4_t VMask;
+static inline VFloat VLoad(const float *p) { return vld1q_f32(p); }
+static inline VFloat VSet(float v) { return vdupq_n_f32(v); }
+static inline VFloat VAdd(VFloat a, VFloat b) { return vaddq_f32(a, b); }
+static inline VFloat VSub(VFloat a, VFloat b) { return vsubq_f32(a, b); }
+static inline VFloat VMul(VFloat a, VFloat b) { return vmulq_f32(a, b); }
+static inline VFloat VDiv(VFloat a, VFloat b) { return vdivq_f32(a, b); }
+static inline VFloat VSqrt(VFloat a) { return vsqrtq_f32(a); }
+static inline VFloat VMax(VFloat a, VFloat b) { return vbslq_f32(vcgtq_f32(a, b), a, b); }
+static inline VFloat VMin(VFloat a, VFloat b) { return vbslq_f32(vcltq_f32(a, b), a, b); }
+static inline VFloat VAbs(VFloat a) { return vabsq_f32(a); }
+static inline VFloat VAnd(VFloat a, VMask m) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), m)); }
+static inline VMask VGreater(VFloat a, VFloat b) { return vcgtq_f32(a, b); }
+static inline VFloat VSelect(VMask m, VFloat a, VFloat b) { return vbslq_f32(m, a, b); }
+static inline VFloat VLaneIndex() { static const float _index[4] = {0.0f, 1.0f, 2.0f, 3.0f}; return vld1q_f32(_index); }
+static inline VMask VNone() { return vdupq_n_u32(0); }
+static inline VMask VOr(VMask a, VMask b) { return vorrq_u32(a, b); }
+static inline bool VAny(VMask m) { return vmaxvq_u32(m) != 0; }
+static inline VFloat VTimeDelta(const HexTime *t, VMask &nonZero)
+{
+    uint32x4_t dt = vsubq_u32(vld1q_u32((const uint32_t *)t), vld1q_u32((const uint32_t *)(t - 1)));
+    nonZero = vmvnq_u32(vceqq_u32(dt, vdupq_n_u32(0)));
+    return vcvtq_f32_s32(vreinterpretq_s32_u32(dt));
+}
+static inline void VStore(float *p, VFloat a) { vst1q_f32(p, a); }
+#endif
+
+#ifdef _TRACK_KERNELS_SIMD_
+// the time lanes are loaded as 32 bit integers
+typedef char _hex_time_must_be_32_bits_for_the_track_kernels_[(sizeof(HexTime) == 4) ? 1 : -1];
+
+static inline float _HorizontalMax(VFloat v)
+{
+    float lanes[_LANES_];
+    VStore(lanes, v);
+    float result = lanes[0];
+    for (int i=1; i<_LANES_; i++)
+    {
+        if (lanes[i] > result)
+            result = lanes[i];
+    }
+    return result;
+}
+
+static inline float _HorizontalMin(VFloat v)
+{
+    float lanes[_LANES_];
+    VStore(lanes, v);
+    float result = lanes[0];
+    for (int i=1; i<_LANES_; i++)
+    {
+        if (lanes[i] < result)
+            result = lanes[i];
+    }
+    return result;
+}
+
+static inline float _HorizontalSum(VFloat v)
+{
+    float lanes[_LANES_];
+    VStore(lanes, v);
+    float result = 0.0f;
+    for (int i=0; i<_LANES_; i++)
+        result += lanes[i];
+    return result;
+}
+#endif
+
+//------------------------------------------------- TrackKernels --------------------------------------------------
+const char *TrackKernels::GetInstructionSet()
+{
+#if defined(_TRACK_KERNELS_AVX2_)
+    return "avx2";
+#elif defined(_TRACK_KERNELS_SSE2_)
+    return "sse2";
+#elif defined(_TRACK_KERNELS_NEON_)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+bool TrackKernels::MaxSegmentSpeed(const float *x, const float *y, const HexTime *time, unsigned int count, float &maxSpeed)
+{
+    maxSpeed = 0.0f;
+    bool res = false;
+    unsigned int i = 1;
+#ifdef _TRACK_KERNELS_SIMD_
+    if (count > _LANES_)
+    {
+        VFloat maxV = VSet(0.0f);
+        VFloat scale = VSet(1000.0f);
+        VMask anyV = VNone();
+        for (; i + _LANES_ <= count; i += _LANES_)
+        {
+            VFloat dx = VSub(VLoad(x + i), VLoad(x + i - 1));
+            VFloat dy = VSub(VLoad(y + i), VLoad(y + i - 1));
+            VMask nonZero;
+            VFloat dt = VTimeDelta(time + i, nonZero);
+            VFloat speed = VDiv(VMul(VSqrt(VAdd(VMul(dx, dx), VMul(dy, dy))), scale), dt);
+            // keep the old value on ties, so a -0.0f never replaces the 0.0f start value
+            maxV = VMax(VAnd(speed, nonZero), maxV);
+            anyV = VOr(anyV, nonZero);
+        }
+        maxSpeed = _HorizontalMax(maxV);
+        res = VAny(anyV);
+    }
+#endif
+    for (; i<count; i++)
+    {
+        int dt = time[i] - time[i - 1];
+        if (dt == 0)
+            continue;
+        float dx = x[i] - x[i - 1];
+        float dy = y[i] - y[i - 1];
+        float speed = sqrtf(dx * dx + dy * dy) * 1000.0f / (float)dt;
+        if (speed > maxSpeed)
+            maxSpeed = speed;
+        res = true;
+    }
+    return res;
+}
+
+void TrackKernels::MaxSegmentDistance(const float *x, const float *y, unsigned int count, float &maxX, float &maxY)
+{
+    maxX = maxY = 0.0f;
+    unsigned int i = 1;
+#ifdef _TRACK_KERNELS_SIMD_
+    if (count > _LANES_)
+    {
+        VFloat maxXV = VSet(0.0f);
+        VFloat maxYV = VSet(0.0f);
+        for (; i + _LANES_ <= count; i += _LANES_)
+        {
+            maxXV = VMax(VAbs(VSub(VLoad(x + i), VLoad(x + i - 1))), maxXV);
+            maxYV = VMax(VAbs(VSub(VLoad(y + i), VLoad(y + i - 1))), maxYV);
+        }
+        maxX = _HorizontalMax(maxXV);
+        maxY = _HorizontalMax(maxYV);
+    }
+#endif
+    for (; i<count; i++)
+    {
+        float dx = fabsf(x[i] - x[i - 1]);
+        float dy = fabsf(y[i] - y[i - 1]);
+        if (dx > maxX)
+            maxX = dx;
+        if (dy > maxY)
+            maxY = dy;
+    }
+}
+
+void TrackKernels::BoundingBox(const float *x, const float *y, unsigned int count, float &minX, float &minY, float &maxX, float &maxY)
+{
+    if (count == 0)
+    {
+        minX = minY = maxX = maxY = 0.0f;
+        return;
+    }
+    minX = maxX = x[0];
+    minY = maxY = y[0];
+    unsigned int i = 0;
+#ifdef _TRACK_KERNELS_SIMD_
+    if (count >= _LANES_)
+    {
+        VFloat minXV = VLoad(x), maxXV = minXV;
+        VFloat minYV = VLoad(y), maxYV = minYV;
+        for (i = _LANES_; i + _LANES_ <= count; i += _LANES_)
+        {
+            VFloat vx = VLoad(x + i);
+            VFloat vy = VLoad(y + i);
+            minXV = VMin(vx, minXV);
+            maxXV = VMax(vx, maxXV);
+            minYV = VMin(vy, minYV);
+            maxYV = VMax(vy, maxYV);
+        }
+        minX = _HorizontalMin(minXV);
+        maxX = _HorizontalMax(maxXV);
+        minY = _HorizontalMin(minYV);
+        maxY = _HorizontalMax(maxYV);
+    }
+#endif
+    for (; i<count; i++)
+    {
+        if (x[i] < minX)
+            minX = x[i];
+        if (x[i] > maxX)
+            maxX = x[i];
+        if (y[i] < minY)
+            minY = y[i];
+        if (y[i] > maxY)
+            maxY = y[i];
+    }
+}
+
+void TrackKernels::Centroid(const float *x, const float *y, unsigned int count, float &centerX, float &centerY)
+{
+    centerX = centerY = 0.0f;
+    if (count == 0)
+        return;
+    float sumX = 0.0f;
+    float sumY = 0.0f;
+    unsigned int i = 0;
+#ifdef _TRACK_KERNELS_SIMD_
+    VFloat sumXV = VSet(0.0f);
+    VFloat sumYV = VSet(0.0f);
+    for (; i + _LANES_ <= count; i += _LANES_)
+    {
+        sumXV = VAdd(sumXV, VLoad(x + i));
+        sumYV = VAdd(sumYV, VLoad(y + i));
+    }
+    sumX = _HorizontalSum(sumXV);
+    sumY = _HorizontalSum(sumYV);
+#endif
+    for (; i<count; i++)
+    {
+        sumX += x[i];
+        sumY += y[i];
+    }
+    centerX = sumX / (float)count;
+    centerY = sumY / (float)count;
+}
+
+float TrackKernels::PathLength(const float *x, const float *y, unsigned int count)
+{
+    float length = 0.0f;
+    unsigned int i = 1;
+#ifdef _TRACK_KERNELS_SIMD_
+    if (count > _LANES_)
+    {
+        VFloat lengthV = VSet(0.0f);
+        for (; i + _LANES_ <= count; i += _LANES_)
+        {
+            VFloat dx = VSub(VLoad(x + i), VLoad(x + i - 1));
+            VFloat dy = VSub(VLoad(y + i), VLoad(y + i - 1));
+            lengthV = VAdd(lengthV, VSqrt(VAdd(VMul(dx, dx), VMul(dy, dy))));
+        }
+        length = _HorizontalSum(lengthV);
+    }
+#endif
+    for (; i<count; i++)
+    {
+        float dx = x[i] - x[i - 1];
+        float dy = y[i] - y[i - 1];
+        length += sqrtf(dx * dx + dy * dy);
+    }
+    return length;
+}
+
+unsigned int TrackKernels::MaxPerpendicularOffset(const float *x, const float *y, unsigned int count, float originX, float originY,
+        float dirX, float dirY, float bias, float &maxDistance, float &offset)
+{
+    maxDistance = -1e20f;
+    offset = 0.0f;
+    unsigned int maxIndex = count;
+    unsigned int i = 0;
+#ifdef _TRACK_KERNELS_SIMD_
+    if (count >= _LANES_)
+    {
+        // per lane: max distance, its offset and index, only a strictly greater distance replaces them
+        VFloat ox = VSet(originX);
+        VFloat oy = VSet(originY);
+        VFloat dx = VSet(dirX);
+        VFloat dy = VSet(dirY);
+        VFloat b = VSet(bias);
+        VFloat indexV = VLaneIndex();
+        VFloat step = VSet((float)_LANES_);
+        VFloat maxV = VSet(-1e20f);
+        VFloat offsetV = VSet(0.0f);
+        VFloat maxIndexV = VSet(0.0f);
+        for (; i + _LANES_ <= count; i += _LANES_)
+        {
+            VFloat off = VSub(VMul(dx, VSub(VLoad(y + i), oy)), VMul(dy, VSub(VLoad(x + i), ox)));
+            VFloat dist = VAbs(VSub(off, b));
+            VMask greater = VGreater(dist, maxV);
+            maxV = VSelect(greater, dist, maxV);
+            offsetV = VSelect(greater, off, offsetV);
+            maxIndexV = VSelect(greater, indexV, maxIndexV);
+            indexV = VAdd(indexV, step);
+        }
+        float lanesMax[_LANES_], lanesOffset[_LANES_], lanesIndex[_LANES_];
+        VStore(lanesMax, maxV);
+        VStore(lanesOffset, offsetV);
+        VStore(lanesIndex, maxIndexV);
+        // ties go to the lower index, like the sequential scan
+        for (int l=0; l<_LANES_; l++)
+        {
+            unsigned int index = (unsigned int)lanesIndex[l];
+            if ((lanesMax[l] > maxDistance) || ((lanesMax[l] == maxDistance) && (index < maxIndex)))
+            {
+                maxDistance = lanesMax[l];
+                offset = lanesOffset[l];
+                maxIndex = index;
+            }
+        }
+    }
+#endif
+    for (; i<count; i++)
+    {
+        float off = dirX * (y[i] - originY) - dirY * (x[i] - originX);
+        float dist = fabsf(off - bias);
+        if (dist > maxDistance)
+        {
+            maxDistance = dist;
+            offset = off;
+            maxIndex = i;
+        }
+    }
+    return maxIndex;
+}
+
+unsigned int TrackKernels::NearestPoint(const float *x, const float *y, const float *penalty, unsigned int count, float px, float py,
+        float &distanceSquared)
+{
+    float minDistance = 1e38f;
+    unsigned int minIndex = count;
+    unsigned int i = 0;
+#ifdef _TRACK_KERNELS_SIMD_
+    if (count >= _LANES_)
+    {
+        // per lane: min value and its index, only a strictly smaller value replaces them
+        VFloat pxV = VSet(px);
+        VFloat pyV = VSet(py);
+        VFloat indexV = VLaneIndex();
+        VFloat step = VSet((float)_LANES_);
+        VFloat minV = VSet(1e38f);
+        VFloat minIndexV = VSet(0.0f);
+        for (; i + _LANES_ <= count; i += _LANES_)
+        {
+            VFloat dx = VSub(VLoad(x + i), pxV);
+            VFloat dy = VSub(VLoad(y + i), pyV);
+            VFloat d = VAdd(VAdd(VMul(dx, dx), VMul(dy, dy)), VLoad(penalty + i));
+            VMask smaller = VGreater(minV, d);
+            minV = VSelect(smaller, d, minV);
+            minIndexV = VSelect(smaller, indexV, minIndexV);
+            indexV = VAdd(indexV, step);
+        }
+        float lanesMin[_LANES_], lanesIndex[_LANES_];
+        VStore(lanesMin, minV);
+        VStore(lanesIndex, minIndexV);
+        // ties go to the lower index, like the sequential scan
+        for (int l=0; l<_LANES_; l++)
+        {
+            unsigned int index = (unsigned int)lanesIndex[l];
+            if ((lanesMin[l] < minDistance) || ((lanesMin[l] == minDistance) && (index < minIndex)))
+            {
+                minDistance = lanesMin[l];
+                minIndex = index;
+            }
+        }
+    }
+#endif
+    for (; i<count; i++)
+    {
+        float dx = x[i] - px;
+        float dy = y[i] - py;
+        float d = dx * dx + dy * dy + penalty[i];
+        if (d < minDistance)
+        {
+            minDistance = d;
+            minIndex = i;
+        }
+    }
+    if (minIndex == count)
+    {
+        distanceSquared = 0.0f;
+        return count;
+    }
+    float dx = x[minIndex] - px;
+    float dy = y[minIndex] - py;
+    distanceSquared = dx * dx + dy * dy;
+    return minIndex;
+}
+
+void TrackKernels::NearestDistances(const float *ax, const float *ay, unsigned int countA, const float *bx, const float *by, unsigned int countB,
+        float *distanceSquared)
+{
+    unsigned int i = 0;
+#ifdef _TRACK_KERNELS_SIMD_
+    // the lanes run over the points of a, no horizontal step
+    for (; i + _LANES_ <= countA; i += _LANES_)
+    {
+        VFloat x = VLoad(ax + i);
+        VFloat y = VLoad(ay + i);
+        VFloat minV = VSet(1e38f);
+        for (unsigned int j=0; j<countB; j++)
+        {
+            VFloat dx = VSub(x, VSet(bx[j]));
+            VFloat dy = VSub(y, VSet(by[j]));
+            minV = VMin(VAdd(VMul(dx, dx), VMul(dy, dy)), minV);
+        }
+        VStore(distanceSquared + i, minV);
+    }
+#endif
+    for (; i<countA; i++)
+    {
+        float minDistance = 1e38f;
+        for (unsigned int j=0; j<countB; j++)
+        {
+            float dx = ax[i] - bx[j];
+            float dy = ay[i] - by[j];
+            float d = dx * dx + dy * dy;
+            if (d < minDistance)
+                minDistance = d;
+        }
+        distanceSquared[i] = minDistance;
+    }
+}
+
+float TrackKernels::SumAbsDifference(const float *a, const float *b, unsigned int count)
+{
+    float sum = 0.0f;
+    unsigned int i = 0;
+#ifdef _TRACK_KERNELS_SIMD_
+    VFloat sumV = VSet(0.0f);
+    for (; i + _LANES_ <= count; i += _LANES_)
+        sumV = VAdd(sumV, VAbs(VSub(VLoad(a + i), VLoad(b + i))));
+    sum = _HorizontalSum(sumV);
+#endif
+    for (; i<count; i++)
+        sum += fabsf(a[i] - b[i]);
+    return sum;
+}
@@ -0,0 +1,43 @@
+#ifndef TOUCH_TRACK_KERNELS_H_
+#define TOUCH_TRACK_KERNELS_H_
+
+#include "input/GesturePlatform.h"
+
+// note: vectorized queries over the structure-of-arrays touch track (see TouchTrack.h)
+// AVX2, SSE2 or NEON (AArch64) is picked at compile time, the scalar path is used for the rest
+// max / min based kernels return exactly the scalar results, the summing kernels may differ in the last bits
+namespace TrackKernels
+{
+    // name of the compiled instruction set, "avx2", "sse2", "neon" or "scalar"
+    const char *GetInstructionSet();
+
+    // max speed (pixels per second) of the segments with a non-zero duration, returns false if there is none
+    bool MaxSegmentSpeed(const float *x, const float *y, const HexTime *time, unsigned int count, float &maxSpeed);
+
+    // max |dx| and |dy| between two neighbour points
+    void MaxSegmentDistance(const float *x, const float *y, unsigned int count, float &maxX, float &maxY);
+
+    void BoundingBox(const float *x, const float *y, unsigned int count, float &minX, float &minY, float &maxX, float &maxY);
+    void Centroid(const float *x, const float *y, unsigned int count, float &centerX, float &centerY);
+    float PathLength(const float *x, const float *y, unsigned int count);
+
+    // 2d projection of the points onto the normal of the unit direction (dirX, dirY) through (originX, originY):
+    //   offset = dirX * (y - originY) - dirY * (x - originX)
+    // finds the first point with the max |offset - bias|, returns its index (count if there is no point)
+    // maxDistance gets |offset - bias| and offset the signed offset of that point
+    unsigned int MaxPerpendicularOffset(const float *x, const float *y, unsigned int count, float originX, float originY,
+            float dirX, float dirY, float bias, float &maxDistance, float &offset);
+
+    // point cloud matching (see PointCloudLibrary.h)
+    // the first point with the min (x - px)^2 + (y - py)^2 + penalty, returns its index (count if there is no point)
+    // a large penalty (1e30f) takes a point out of the search, distanceSquared gets the value without the penalty
+    unsigned int NearestPoint(const float *x, const float *y, const float *penalty, unsigned int count, float px, float py,
+            float &distanceSquared);
+    // for every point of a: the squared distance to the nearest point of b
+    void NearestDistances(const float *ax, const float *ay, unsigned int countA, const float *bx, const float *by, unsigned int countB,
+            float *distanceSquared);
+    // sum of |a - b|
+    float SumAbsDifference(const float *a, const float *b, unsigned int count);
+}
+
+#endif
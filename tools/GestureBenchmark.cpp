@@ -0,0 +1,450 @@
+// microbenchmarks for the per-frame cost of gesture recognition
+// usage: GestureBenchmark [min milliseconds per case, default 50]
+// exits with 1 if a warmed up TouchManager::Update allocated
+//
+// every case reports the time per call and the heap allocations per call,
+// the allocations are counted by replacing the global operator new in this executable, plus the blocks of the
+// gesture core (GestureMemory::GetAllocationCount)
+
+#include "input/TouchManager.h"
+#include "input/BaseGestureRecognizer.h"
+#include "input/TouchTrackKernels.h"
+#include "input/StaticTouchManager.h"
+#include "input/PointCloudLibrary.h"
+#include "input/GestureMemory.h"
+#include <chrono>
+
+static unsigned long long _allocation_count = 0;
+
+static inline unsigned long long _AllocationCount()
+{
+    return _allocation_count + GestureMemory::GetAllocationCount();
+}
+
+void *operator new(size_t size)
+{
+    _allocation_count ++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    _allocation_count ++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static const unsigned int _VIEWPORT_WIDTH_          = 1280;
+static const unsigned int _VIEWPORT_HEIGHT_         = 720;
+static const HexTime _SAMPLE_INTERVAL_              = 4;        // 240 Hz panel
+static const HexTime _FRAME_INTERVAL_               = 16;
+// arena chunks per long contact: a track doubling its run from 32 to 4096 points in a first fit arena leaves the
+// smaller runs it grew through below the last one, 1 + 2 + ... + 64 chunks under the final 128
+static const unsigned int _LONG_CONTACT_ARENA_CHUNKS_ = 4096 / TouchTrackArena::CHUNK_POINTS * 2;
+
+static const unsigned int _track_lengths[]          = {10, 100, 1000, 5000};
+static const unsigned int _contact_counts[]         = {1, 2, 5, 10, 64};
+static const unsigned int _template_counts[]        = {100, 1000, 5000};
+static const unsigned int _candidate_counts[]       = {16, 64, 0};
+
+static double _min_seconds_per_case = 0.05;
+static volatile float _sink = 0.0f;
+// allocations of the measured TouchManager::Update calls, must stay 0
+static unsigned long long _update_allocations = 0;
+
+class NullListener : public TouchManager::GestureListener
+{
+public:
+    virtual void GestureEvent(BaseGestureEvent *event) { _sink += (float)event->GetEventX(); }
+};
+
+//---------------------------- track generators ----------------------------
+// finger held down, jittering below the steady threshold
+static inline void _HoldPoint(unsigned int contact, unsigned int i, int &x, int &y)
+{
+    x = 100 + (int)contact * 100 + (int)(i % 3);
+    y = 300 + (int)((i / 3) % 3);
+}
+
+// half circle from left to right
+static inline void _ArcPoint(unsigned int i, unsigned int count, int &x, int &y)
+{
+    float a = 3.14159265f * (float)i / (float)(count - 1);
+    x = (int)(640.0f - 500.0f * cosf(a));
+    y = (int)(500.0f - 300.0f * sinf(a));
+}
+
+static void _FillHoldTrack(TouchQueue &queue, unsigned int contact, unsigned int count, HexTime start)
+{
+    int x, y;
+    _HoldPoint(contact, 0, x, y);
+    queue.AddTouch(x, y, start);
+    for (unsigned int i=1; i<count; i++)
+    {
+        _HoldPoint(contact, i, x, y);
+        queue.TouchMove(x, y, start + i * _SAMPLE_INTERVAL_);
+    }
+}
+
+static void _FillArcTrack(TouchQueue &queue, unsigned int count, HexTime start)
+{
+    int x, y;
+    _ArcPoint(0, count, x, y);
+    queue.AddTouch(x, y, start);
+    for (unsigned int i=1; i<count; i++)
+    {
+        _ArcPoint(i, count, x, y);
+        queue.TouchMove(x, y, start + i * _SAMPLE_INTERVAL_);
+    }
+}
+
+// random glyph of 1 to 3 strokes, each a polyline of 2 to 5 corners sampled every few pixels
+// jitter moves the corners by up to that many pixels, the same seed gives the same glyph
+static void _FillGlyph(unsigned int seed, float jitter, std::vector<float> &x, std::vector<float> &y, std::vector<unsigned int> &strokes)
+{
+    x.clear();
+    y.clear();
+    strokes.clear();
+    unsigned int state = seed * 2654435761u + 1;
+    unsigned int noise = state ^ 0x9e3779b9u;
+    struct Random
+    {
+        static float Next(unsigned int &s) { s = s * 1664525u + 1013904223u; return (float)(s >> 8) / 16777216.0f; }
+    };
+    unsigned int strokeCount = 1 + (unsigned int)(Random::Next(state) * 3.0f);
+    for (unsigned int s=0; s<strokeCount; s++)
+    {
+        unsigned int corners = 2 + (unsigned int)(Random::Next(state) * 4.0f);
+        float prevX = 0.0f, prevY = 0.0f;
+        for (unsigned int c=0; c<corners; c++)
+        {
+            float cx = 100.0f + 400.0f * Random::Next(state) + jitter * (Random::Next(noise) - 0.5f);
+            float cy = 100.0f + 400.0f * Random::Next(state) + jitter * (Random::Next(noise) - 0.5f);
+            if (c > 0)
+            {
+                for (unsigned int i=1; i<=16; i++)
+                {
+                    float t = (float)i / 16.0f;
+                    x.push_back(prevX + (cx - prevX) * t);
+                    y.push_back(prevY + (cy - prevY) * t);
+                    strokes.push_back(s);
+                }
+            }
+            else
+            {
+                x.push_back(cx);
+                y.push_back(cy);
+                strokes.push_back(s);
+            }
+            prevX = cx;
+            prevY = cy;
+        }
+    }
+}
+
+//---------------------------- runner ----------------------------
+// returns the allocations of the measured calls
+template <class Func>
+static unsigned long long _Run(const char *name, unsigned int points, unsigned int contacts, Func func)
+{
+    // warm up, and size the batch so the clock is read rarely
+    func();
+    unsigned int batch = 1;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (;;)
+    {
+        for (unsigned int i=0; i<batch; i++)
+            func();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (elapsed > 0.001)
+            break;
+        batch *= 2;
+    }
+
+    unsigned long long calls = 0;
+    unsigned long long allocations = _AllocationCount();
+    begin = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < _min_seconds_per_case)
+    {
+        for (unsigned int i=0; i<batch; i++)
+            func();
+        calls += batch;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    allocations = _AllocationCount() - allocations;
+    printf("%-36s %8u %9u %14.1f %12.2f\n", name, points, contacts, elapsed * 1e9 / (double)calls, (double)allocations / (double)calls);
+    return allocations;
+}
+
+//---------------------------- cases ----------------------------
+static void _BenchTouchQueueQueries()
+{
+    for (unsigned int l=0; l<sizeof(_track_lengths) / sizeof(_track_lengths[0]); l++)
+    {
+        unsigned int points = _track_lengths[l];
+        TouchQueue queue(0);
+        _FillArcTrack(queue, points, 1000);
+
+        _Run("TouchQueue::GetMovingSpeeds", points, 1, [&queue]() {
+            float maxSpeed, avgSpeed;
+            queue.GetMovingSpeeds(maxSpeed, avgSpeed);
+            _sink += maxSpeed;
+        });
+        _Run("TouchQueue::GetAbsMaxMovingDistance", points, 1, [&queue]() {
+            int x, y;
+            queue.GetAbsMaxMovingDistance(x, y);
+            _sink += (float)x;
+        });
+        _Run("TouchQueue::IsArcTrack", points, 1, [&queue]() {
+            TouchQueue::ArcShape arcType;
+            TouchQueue::Direction direction;
+            _sink += queue.IsArcTrack(_VIEWPORT_WIDTH_ / 2, 0.25f, arcType, direction) ? 1.0f : 0.0f;
+        });
+        _Run("TouchQueue::ComputeTrackStatistics", points, 1, [&queue]() {
+            TouchQueue::TrackStatistics statistics;
+            queue.ComputeTrackStatistics(0, 0, statistics);
+            _sink += statistics.pathLength;
+        });
+        _Run("TouchQueue::GetTrackCentroid", points, 1, [&queue]() {
+            float x, y;
+            queue.GetTrackCentroid(x, y);
+            _sink += x;
+        });
+    }
+}
+
+static void _BenchRecognizerUpdate()
+{
+    for (unsigned int l=0; l<sizeof(_track_lengths) / sizeof(_track_lengths[0]); l++)
+    {
+        for (unsigned int c=0; c<sizeof(_contact_counts) / sizeof(_contact_counts[0]); c++)
+        {
+            unsigned int points = _track_lengths[l];
+            unsigned int contacts = _contact_counts[c];
+            BaseGestureRecognizer *recognizer = BaseGestureRecognizer::Create("BaseGestureRecognizer");
+            recognizer->Initialize(_VIEWPORT_WIDTH_, _VIEWPORT_HEIGHT_);
+            std::vector<TouchQueue *> queues;
+            HexTime start = 1000;
+            for (unsigned int i=0; i<contacts; i++)
+            {
+                TouchQueue *queue = new TouchQueue(i);
+                _FillHoldTrack(*queue, i, points, start);
+                recognizer->TryAddTouchQueueChanging(queue, 1, start);
+                queues.push_back(queue);
+            }
+            HexTime time = start + points * _SAMPLE_INTERVAL_;
+            _Run("BaseGestureRecognizer::Update", points, contacts, [&recognizer, &time]() {
+                time += _FRAME_INTERVAL_;
+                recognizer->Update(time);
+                recognizer->ClearGestureEvents();
+            });
+            delete recognizer;
+            for (unsigned int i=0; i<queues.size(); i++)
+                delete queues[i];
+        }
+    }
+}
+
+static void _BenchManagerUpdate(const char *name, TouchManager &manager, unsigned int points, unsigned int contacts)
+{
+    NullListener listener;
+    manager.RegisterGestureListener(&listener);
+    GestureClock &clock = manager.GetClock();
+    HexTime time = 1000;
+    for (unsigned int i=0; i<points; i++)
+    {
+        clock.SetManualTime(time + i * _SAMPLE_INTERVAL_);
+        for (unsigned int j=0; j<contacts; j++)
+        {
+            int x, y;
+            _HoldPoint(j, i, x, y);
+            //sparse pointer ids, as reported by the mobile platforms
+            unsigned int pointerId = 0x10000 + j * 7919;
+            if (i == 0)
+                manager.AddTouch(x, y, pointerId);
+            else
+                manager.TouchMove(x, y, pointerId);
+        }
+        //apply the queued samples, the ingestion ring holds a few frames only
+        manager.Update();
+    }
+    time += points * _SAMPLE_INTERVAL_;
+    _update_allocations += _Run(name, points, contacts, [&manager, &clock, &time]() {
+        time += _FRAME_INTERVAL_;
+        clock.SetManualTime(time);
+        manager.Update();
+    });
+    manager.UnRegisterGestureListener(&listener);
+}
+
+// steady state of a session: every contact presses, swipes along an arc in cycle - 2 frames and releases, again and
+// again, so the slots, the track runs of the arena and the event queues are recycled inside the measured loop
+// freshIds: every cycle presses new pointer ids, on a manager with more slots than contacts the slot map hands them
+// the slots released the longest ago, the runs of the released tracks must be back in the arena by then
+static void _BenchManagerGestureCycle(const char *name, TouchManager &manager, unsigned int cycle, unsigned int contacts, bool freshIds)
+{
+    NullListener listener;
+    manager.RegisterGestureListener(&listener);
+    GestureClock &clock = manager.GetClock();
+    HexTime time = 1000;
+    unsigned int frame = 0;
+    auto step = [&manager, &clock, &time, &frame, cycle, contacts, freshIds]() {
+        time += _FRAME_INTERVAL_;
+        clock.SetManualTime(time);
+        unsigned int phase = frame % cycle;
+        for (unsigned int j=0; j<contacts; j++)
+        {
+            int x, y;
+            _ArcPoint(phase < cycle - 2 ? phase : cycle - 3, cycle - 2, x, y);
+            unsigned int pointerId = freshIds ? 0x10000 + (frame / cycle) * contacts + j : 0x10000 + j * 7919 + (frame / cycle % 2);
+            y += (int)j * 8;
+            if (phase == 0)
+                manager.AddTouch(x, y, pointerId);
+            else if (phase < cycle - 2)
+                manager.TouchMove(x, y, pointerId);
+            else if (phase == cycle - 2)
+                manager.ReleaseTouch(x, y, pointerId);
+        }
+        manager.Update();
+        frame ++;
+    };
+    //a few cycles to warm up the tracks, the rings and the recognizer tables
+    for (unsigned int i=0; i<cycle * 4; i++)
+        step();
+    _update_allocations += _Run(name, cycle, contacts, step);
+    manager.UnRegisterGestureListener(&listener);
+}
+
+static void _BenchTouchManagerUpdate()
+{
+    for (unsigned int l=0; l<sizeof(_track_lengths) / sizeof(_track_lengths[0]); l++)
+    {
+        for (unsigned int c=0; c<sizeof(_contact_counts) / sizeof(_contact_counts[0]); c++)
+        {
+            unsigned int points = _track_lengths[l];
+            unsigned int contacts = _contact_counts[c];
+            TouchManager manager(contacts);
+            manager.RegisterGestureRecognizer("BaseGestureRecognizer");
+            manager.GetGestureRecognizer()->Initialize(_VIEWPORT_WIDTH_, _VIEWPORT_HEIGHT_);
+            _BenchManagerUpdate("TouchManager::Update", manager, points, contacts);
+        }
+    }
+    for (unsigned int c=0; c<sizeof(_contact_counts) / sizeof(_contact_counts[0]); c++)
+    {
+        unsigned int contacts = _contact_counts[c];
+        TouchManager manager(contacts);
+        manager.RegisterGestureRecognizer("BaseGestureRecognizer");
+        manager.GetGestureRecognizer()->Initialize(_VIEWPORT_WIDTH_, _VIEWPORT_HEIGHT_);
+        _BenchManagerGestureCycle("TouchManager::Update (gesture cycle)", manager, 24, contacts, false);
+    }
+    //twice the slots of the contacts and new pointer ids every cycle, the released slots rotate
+    for (unsigned int c=0; c<sizeof(_contact_counts) / sizeof(_contact_counts[0]); c++)
+    {
+        unsigned int contacts = _contact_counts[c];
+        TouchManager manager(contacts * 2);
+        manager.RegisterGestureRecognizer("BaseGestureRecognizer");
+        manager.GetGestureRecognizer()->Initialize(_VIEWPORT_WIDTH_, _VIEWPORT_HEIGHT_);
+        _BenchManagerGestureCycle("TouchManager::Update (rotating slots)", manager, 24, contacts, true);
+    }
+    //contacts longer than the default arena holds, on rotating slots: the arena is sized for the contacts in flight
+    //(4096 points and the run they grow out of), not for the slots
+    for (unsigned int c=0; c<sizeof(_contact_counts) / sizeof(_contact_counts[0]); c++)
+    {
+        unsigned int contacts = _contact_counts[c];
+        TouchManager manager(contacts * 2, contacts * _LONG_CONTACT_ARENA_CHUNKS_);
+        manager.RegisterGestureRecognizer("BaseGestureRecognizer");
+        manager.GetGestureRecognizer()->Initialize(_VIEWPORT_WIDTH_, _VIEWPORT_HEIGHT_);
+        _BenchManagerGestureCycle("TouchManager::Update (long contacts)", manager, 4096, contacts, true);
+    }
+}
+
+static void _BenchStaticTouchManagerUpdate()
+{
+    // DefaultGesturePolicy: 1280 x 720, 10 contacts, 256 stored points per track
+    for (unsigned int l=0; l<sizeof(_track_lengths) / sizeof(_track_lengths[0]); l++)
+    {
+        for (unsigned int c=0; c<sizeof(_contact_counts) / sizeof(_contact_counts[0]); c++)
+        {
+            unsigned int points = _track_lengths[l];
+            unsigned int contacts = _contact_counts[c];
+            if (contacts > DefaultGesturePolicy::MAX_CONTACTS)
+                continue;
+            StaticTouchManager<> *manager = new StaticTouchManager<>();
+            _BenchManagerUpdate("StaticTouchManager::Update", *manager, points, contacts);
+            delete manager;
+        }
+    }
+}
+
+static void _BenchPointCloudMatch()
+{
+    printf("%-36s %8s %9s %14s %12s\n", "case", "templates", "candidates", "ns/op", "allocs/op");
+    std::vector<float> x, y;
+    std::vector<unsigned int> strokes;
+    for (unsigned int t=0; t<sizeof(_template_counts) / sizeof(_template_counts[0]); t++)
+    {
+        PointCloudLibrary library;
+        for (unsigned int i=0; i<_template_counts[t]; i++)
+        {
+            _FillGlyph(i, 0.0f, x, y, strokes);
+            library.AddTemplate("glyph", &x[0], &y[0], &strokes[0], x.size());
+        }
+        // distorted copies of the templates, the hit rate shows what the coarse ranking costs in accuracy
+        const unsigned int queryCount = 64;
+        std::vector<PointCloudLibrary::PointCloud> queries(queryCount);
+        for (unsigned int q=0; q<queryCount; q++)
+        {
+            _FillGlyph(q * 7 % _template_counts[t], 20.0f, x, y, strokes);
+            PointCloudLibrary::Normalize(&x[0], &y[0], &strokes[0], x.size(), queries[q]);
+        }
+        for (unsigned int c=0; c<sizeof(_candidate_counts) / sizeof(_candidate_counts[0]); c++)
+        {
+            library.SetCandidateCount(_candidate_counts[c]);
+            PointCloudLibrary::MatchBuffers buffers;
+            unsigned int hits = 0;
+            for (unsigned int q=0; q<queryCount; q++)
+            {
+                float score;
+                if (library.Match(queries[q], score, buffers) == q * 7 % _template_counts[t])
+                    hits ++;
+            }
+            unsigned int next = 0;
+            _Run("PointCloudLibrary::Match", _template_counts[t], _candidate_counts[c], [&library, &queries, &buffers, &next]() {
+                float score;
+                _sink += (float)library.Match(queries[next], score, buffers);
+                next = (next + 1) % queries.size();
+            });
+            printf("%-36s %8u %9u %13u%%\n", "  hit rate", _template_counts[t], _candidate_counts[c], hits * 100 / queryCount);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        _min_seconds_per_case = atof(argv[1]) / 1000.0;
+    printf("track kernels: %s\n", TrackKernels::GetInstructionSet());
+    printf("%-36s %8s %9s %14s %12s\n", "case", "points", "contacts", "ns/op", "allocs/op");
+    _BenchTouchQueueQueries();
+    _BenchRecognizerUpdate();
+    _BenchTouchManagerUpdate();
+    _BenchStaticTouchManagerUpdate();
+    _BenchPointCloudMatch();
+    if (_update_allocations)
+    {
+        printf("TouchManager::Update allocated %llu times after warming up\n", _update_allocations);
+        return 1;
+    }
+    return 0;
+}
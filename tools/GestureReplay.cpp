@@ -0,0 +1,247 @@
+// replays binary touch traces through TouchManager and reports the recognized gestures and the replay speed
+// usage: GestureReplay [-v] [-s] [-c pixels] [-t] [-x timeline.json] [-i] [-j workers] trace0.gtrc [trace1.gtrc ...]
+//   -v  print every event
+//   -s  replay through StaticTouchManager<DefaultGesturePolicy> (compile time viewport, the trace viewport is ignored)
+//   -c  coalesce the moves within that many pixels (TouchManager::SetMoveCoalescing)
+//   -t  print the instrumentation snapshot of every trace (counters in GESTURE_ENABLE_STATS builds only)
+//   -x  export the recognizer timeline of the last trace as Chrome trace JSON (GestureTraceSink)
+//   -i  recognize at input time (TouchManager::SetInputTimeRecognition), the update records poll the time outs
+//   -j  replay all traces at once with GestureBatchEngine on that many threads (0 for every hardware thread),
+//       the output is the same as the sequential replay apart from the timings
+
+#include "input/TouchManager.h"
+#include "input/BaseGestureRecognizer.h"
+#include "input/StaticTouchManager.h"
+#include "input/TouchTrace.h"
+#include "input/GestureBatchEngine.h"
+#include "input/GestureTraceSink.h"
+#include <chrono>
+
+class ReplayListener : public TouchManager::GestureListener
+{
+public:
+    ReplayListener(bool verbose) : mVerbose(verbose), mEventCount(0)
+    {
+        memset(mEventCountByType, 0, sizeof(mEventCountByType));
+    }
+
+    virtual void GestureEvent(BaseGestureEvent *event)
+    {
+        mEventCount ++;
+        if (event->GetEventType() < 16)
+            mEventCountByType[event->GetEventType()] ++;
+        if (mVerbose)
+            printf("  %8u  type %2u  (%d, %d)  touches %u\n", (unsigned int)event->GetEventTime(), (unsigned int)event->GetEventType(),
+                    event->GetEventX(), event->GetEventY(), event->GetTouchCount());
+    }
+
+    void PrintEventCounts()
+    {
+        for (unsigned int t=0; t<16; t++)
+        {
+            if (mEventCountByType[t])
+                printf("    type %2u: %u\n", t, mEventCountByType[t]);
+        }
+    }
+
+    bool mVerbose;
+    unsigned int mEventCount;
+    unsigned int mEventCountByType[16];
+};
+
+static void _PrintStats(const GestureStatsSnapshot &stats)
+{
+    static const char *_HANDLER_NAMES_[GestureRecognizerStats::HANDLER_COUNT] =
+    {
+        "tap", "move", "swipe", "long tap", "double tap", "drag", "drag move", "multi touch",
+    };
+    if (stats.enabled)
+    {
+        printf("  %llu updates, %.1f us avg, %.1f us max, %llu events dispatched, changed queues max %u\n", stats.updateCount,
+                stats.updateCount ? (double)stats.updateNanoseconds / 1000.0 / (double)stats.updateCount : 0.0,
+                (double)stats.maxUpdateNanoseconds / 1000.0, stats.eventsDispatched, stats.maxChangedQueueDepth);
+        for (unsigned int h=0; h<GestureRecognizerStats::HANDLER_COUNT; h++)
+        {
+            if (stats.handlerCalls[h])
+                printf("    %-12s %10llu calls  %8.1f ns avg\n", _HANDLER_NAMES_[h], stats.handlerCalls[h],
+                        (double)stats.handlerNanoseconds[h] / (double)stats.handlerCalls[h]);
+        }
+    }
+    printf("  %u events and %u samples dropped, %u active tracks, %u points (max %u), %u track bytes\n", stats.eventsDropped,
+            stats.samplesDropped, stats.activeTracks, stats.trackPoints, stats.maxTrackPoints, stats.trackBytes);
+    if (stats.arenaBytes)
+        printf("  track arena %u of %u bytes used, %u runs from the heap\n", stats.arenaUsedBytes, stats.arenaBytes,
+                stats.arenaOverflows);
+}
+
+static int _ReplayBatch(const std::vector<const char *> &paths, bool verbose, unsigned int workerCount)
+{
+    std::vector<TouchTraceReader *> readers;
+    unsigned long long totalRecords = 0;
+    unsigned long long totalTraceTime = 0;
+    for (unsigned int i=0; i<paths.size(); i++)
+    {
+        TouchTraceReader *reader = new TouchTraceReader();
+        if (!reader->Open(paths[i]))
+        {
+            fprintf(stderr, "failed to open trace %s\n", paths[i]);
+            delete reader;
+            for (unsigned int r=0; r<readers.size(); r++)
+                delete readers[r];
+            return 1;
+        }
+        totalRecords += reader->GetRecordCount();
+        totalTraceTime += reader->GetDuration();
+        readers.push_back(reader);
+    }
+    GestureBatchEngine engine(workerCount);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    engine.Run(&readers[0], readers.size());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    for (unsigned int i=0; i<readers.size(); i++)
+    {
+        printf("%s: %u records, %u ms, viewport %u x %u\n", paths[i], readers[i]->GetRecordCount(), (unsigned int)readers[i]->GetDuration(),
+                readers[i]->GetViewportWidth(), readers[i]->GetViewportHeight());
+        ReplayListener listener(verbose);
+        unsigned int count;
+        const BaseGestureEvent *events = engine.GetSessionEvents(i, count);
+        for (unsigned int e=0; e<count; e++)
+            listener.GestureEvent(const_cast<BaseGestureEvent *>(&events[e]));
+        printf("  %u events\n", listener.mEventCount);
+        listener.PrintEventCounts();
+        delete readers[i];
+    }
+    if (seconds > 0.0)
+    {
+        printf("replayed %u trace(s) on %u worker(s), %u stolen, %llu records, %.0f records/s, %.0fx real time\n", (unsigned int)paths.size(),
+                engine.GetWorkerCount(), engine.GetStolenSessionCount(), totalRecords, (double)totalRecords / seconds,
+                (double)totalTraceTime / 1000.0 / seconds);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = false;
+    bool useStatic = false;
+    bool inputTime = false;
+    unsigned int coalescing = 0;
+    bool printStats = false;
+    const char *timelinePath = 0;
+    bool batch = false;
+    unsigned int workerCount = 0;
+    std::vector<const char *> batchPaths;
+    int fileCount = 0;
+    unsigned long long totalRecords = 0;
+    unsigned long long totalTraceTime = 0;
+    double totalWallTime = 0.0;
+    for (int i=1; i<argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+        {
+            verbose = true;
+            continue;
+        }
+        if (strcmp(argv[i], "-s") == 0)
+        {
+            useStatic = true;
+            continue;
+        }
+        if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc))
+        {
+            coalescing = (unsigned int)atoi(argv[++i]);
+            continue;
+        }
+        if ((strcmp(argv[i], "-x") == 0) && (i + 1 < argc))
+        {
+            timelinePath = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "-t") == 0)
+        {
+            printStats = true;
+            continue;
+        }
+        if (strcmp(argv[i], "-i") == 0)
+        {
+            inputTime = true;
+            continue;
+        }
+        if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc))
+        {
+            batch = true;
+            workerCount = (unsigned int)atoi(argv[++i]);
+            continue;
+        }
+        if (batch)
+        {
+            batchPaths.push_back(argv[i]);
+            continue;
+        }
+        TouchTraceReader reader;
+        if (!reader.Open(argv[i]))
+        {
+            fprintf(stderr, "failed to open trace %s\n", argv[i]);
+            return 1;
+        }
+        ReplayListener listener(verbose);
+        TouchManager *manager;
+        if (useStatic)
+        {
+            manager = new StaticTouchManager<>();
+        }
+        else
+        {
+            manager = new TouchManager();
+            manager->RegisterGestureRecognizer("BaseGestureRecognizer");
+            if (reader.GetViewportWidth() && reader.GetViewportHeight())
+                manager->GetGestureRecognizer()->Initialize(reader.GetViewportWidth(), reader.GetViewportHeight());
+        }
+        manager->RegisterGestureListener(&listener);
+        manager->SetInputTimeRecognition(inputTime);
+        manager->SetMoveCoalescing(coalescing);
+        GestureTraceSink *timeline = timelinePath ? new GestureTraceSink() : 0;
+        manager->SetTraceSink(timeline);
+
+        printf("%s: %u records, %u ms, viewport %u x %u\n", argv[i], reader.GetRecordCount(), (unsigned int)reader.GetDuration(),
+                reader.GetViewportWidth(), reader.GetViewportHeight());
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        unsigned int records = reader.Replay(manager);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        unsigned int coalesced = manager->GetCoalescedSampleCount();
+        GestureStatsSnapshot stats;
+        manager->GetStatsSnapshot(stats);
+        delete manager;
+        printf("  %u events in %.3f ms\n", listener.mEventCount, seconds * 1000.0);
+        if (coalescing)
+            printf("  %u moves coalesced\n", coalesced);
+        if (printStats)
+            _PrintStats(stats);
+        if (timeline)
+        {
+            if (!timeline->ExportChromeTrace(timelinePath))
+                fprintf(stderr, "failed to write %s\n", timelinePath);
+            else
+                printf("  %u timeline records (%u overwritten) in %s\n", timeline->GetRecordCount(), timeline->GetOverwrittenCount(), timelinePath);
+            delete timeline;
+        }
+        listener.PrintEventCounts();
+        fileCount ++;
+        totalRecords += records;
+        totalTraceTime += reader.GetDuration();
+        totalWallTime += seconds;
+    }
+    if (batch && !batchPaths.empty())
+        return _ReplayBatch(batchPaths, verbose, workerCount);
+    if (!fileCount)
+    {
+        fprintf(stderr, "usage: %s [-v] [-s] [-c pixels] [-t] [-x timeline.json] [-i] [-j workers] trace0.gtrc [trace1.gtrc ...]\n", argv[0]);
+        return 1;
+    }
+    if (totalWallTime > 0.0)
+    {
+        printf("replayed %d trace(s), %llu records, %.0f records/s, %.0fx real time\n", fileCount, totalRecords,
+                (double)totalRecords / totalWallTime, (double)totalTraceTime / 1000.0 / totalWallTime);
+    }
+    return 0;
+}